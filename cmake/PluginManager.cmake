@@ -1,11 +1,28 @@
-
 # Installs a plugin info .xml file to INSTALL_FOLDER/lib/plugin_manager/
+# and updates the registry bundle of that folder
 function(install_plugin_info TARGET_NAME)
     if(EXISTS ${CMAKE_CURRENT_SOURCE_DIR}/${TARGET_NAME}.xml)
         file(GLOB plugin_files "${CMAKE_CURRENT_SOURCE_DIR}/${TARGET_NAME}.xml")
         install(FILES ${plugin_files}
                 DESTINATION lib/plugin_manager)
+        install_plugin_bundle()
     else()
         message("plugin export: ${CMAKE_CURRENT_SOURCE_DIR}/${TARGET_NAME}.xml is not available for export")
     endif()
-endfunction()
\ No newline at end of file
+endfunction()
+
+# Compiles all plugin info .xml files in INSTALL_FOLDER/lib/plugin_manager/ into
+# a registry bundle at install time, which is loaded instead of parsing the xml files.
+# When cross compiling PLUGIN_MANAGER_BUNDLE_EXECUTABLE has to point to a host build of the tool.
+function(install_plugin_bundle)
+    if(NOT PLUGIN_MANAGER_BUNDLE_EXECUTABLE)
+        message("plugin export: plugin_manager_bundle is not available, no registry bundle is created")
+        return()
+    endif()
+    install(CODE "
+        execute_process(COMMAND \"${PLUGIN_MANAGER_BUNDLE_EXECUTABLE}\" \"\$ENV{DESTDIR}\${CMAKE_INSTALL_PREFIX}/lib/plugin_manager\"
+                        RESULT_VARIABLE bundle_result)
+        if(NOT bundle_result EQUAL 0)
+            message(WARNING \"plugin export: failed to create the registry bundle of \${CMAKE_INSTALL_PREFIX}/lib/plugin_manager\")
+        endif()")
+endfunction()
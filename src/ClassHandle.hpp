@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include "PluginInfo.hpp"
+
+namespace plugin_manager
+{
+
+class PluginManager;
+
+/**
+ * @class ClassHandle
+ * @brief A resolved plugin class, see PluginManager::resolve.
+ * The name of the class is resolved once when the handle is created, queries and
+ * instance creation with a handle don't look up the class again.
+ * A handle keeps the plugin information it was resolved to. If the class is removed or
+ * changed by a reload the handle still refers to the previous definition, it has to be
+ * resolved again to see the change.
+ */
+class ClassHandle
+{
+    friend class PluginManager;
+
+public:
+    /**
+     * @brief Creates an invalid handle
+     */
+    ClassHandle() {}
+
+    /**
+     * @brief Returns true if the handle refers to a class
+     */
+    bool isValid() const { return plugin_info.get() != NULL; }
+
+    /**
+     * @brief Returns the full class name with namespace, the handle must be valid
+     */
+    const std::string& getFullClassName() const { return plugin_info->full_class_name; }
+
+    /**
+     * @brief Returns the class name without namespace, the handle must be valid
+     */
+    const std::string& getClassName() const { return plugin_info->class_name; }
+
+    /**
+     * @brief Returns the full name of the class as spelled in the xml file, i.e. the name
+     *        the class is expected to be registered with in its library
+     */
+    const std::string& getRegisteredClassName() const
+    {
+        return plugin_info->xml_class_name.empty() ? plugin_info->full_class_name : plugin_info->xml_class_name;
+    }
+
+    /**
+     * @brief Returns the full name of the base class, the handle must be valid
+     */
+    const std::string& getBaseClassName() const { return plugin_info->base_class_name; }
+
+    /**
+     * @brief Returns the library path of the class, the handle must be valid
+     */
+    const std::string& getLibraryPath() const { return plugin_info->library_path; }
+
+    /**
+     * @brief Returns the singleton flag of the class, the handle must be valid
+     */
+    bool isSingleton() const { return plugin_info->singleton; }
+
+private:
+    explicit ClassHandle(const boost::shared_ptr<PluginInfo>& plugin_info) : plugin_info(plugin_info) {}
+
+    boost::shared_ptr<PluginInfo> plugin_info;
+};
+
+}
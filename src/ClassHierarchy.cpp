@@ -0,0 +1,113 @@
+#include "ClassHierarchy.hpp"
+#include <algorithm>
+#include <glog/logging.h>
+
+using namespace plugin_manager;
+
+static const uint32_t no_base_bit = 0xFFFFFFFF;
+
+void ClassHierarchy::addClass(boost::string_view class_name, boost::string_view base_class_name)
+{
+    addRelation(class_name, base_class_name, true);
+}
+
+void ClassHierarchy::addBaseClass(boost::string_view type_name, boost::string_view base_class_name)
+{
+    addRelation(type_name, base_class_name, false);
+}
+
+void ClassHierarchy::addRelation(boost::string_view type_name, boost::string_view base_class_name, bool is_class)
+{
+    StringId type = names.intern(type_name);
+    StringId base = names.intern(base_class_name);
+    direct_bases.resize(names.size());
+    this->is_class.resize(names.size(), false);
+    if(is_class)
+        this->is_class[type] = true;
+    if(type != base && std::find(direct_bases[type].begin(), direct_bases[type].end(), base) == direct_bases[type].end())
+        direct_bases[type].push_back(base);
+}
+
+void ClassHierarchy::update()
+{
+    // only types which are used as base class get a bit
+    uint32_t base_count = 0;
+    base_bits.assign(names.size(), no_base_bit);
+    for(const std::vector<StringId>& bases : direct_bases)
+    {
+        for(StringId base : bases)
+        {
+            if(base_bits[base] == no_base_bit)
+                base_bits[base] = base_count++;
+        }
+    }
+
+    ancestors.assign(names.size(), boost::dynamic_bitset<uint64_t>(base_count));
+    std::vector<uint8_t> state(names.size(), 0);
+    for(StringId type = 0; type < names.size(); type++)
+        computeAncestors(type, state);
+
+    subclasses.assign(base_count, std::vector<StringId>());
+    for(StringId type = 0; type < names.size(); type++)
+    {
+        if(!is_class[type])
+            continue;
+        for(size_t bit = ancestors[type].find_first(); bit != boost::dynamic_bitset<uint64_t>::npos; bit = ancestors[type].find_next(bit))
+            subclasses[bit].push_back(type);
+    }
+    for(std::vector<StringId>& classes : subclasses)
+    {
+        std::sort(classes.begin(), classes.end(),
+                  [this](StringId a, StringId b) { return names.get(a) < names.get(b); });
+    }
+}
+
+void ClassHierarchy::computeAncestors(StringId type, std::vector<uint8_t>& state)
+{
+    if(state[type] == 2)
+        return;
+    if(state[type] == 1)
+    {
+        LOG(WARNING) << "The base classes of " << names.get(type) << " are cyclic.";
+        return;
+    }
+
+    state[type] = 1;
+    for(StringId base : direct_bases[type])
+    {
+        computeAncestors(base, state);
+        ancestors[type].set(base_bits[base]);
+        ancestors[type] |= ancestors[base];
+    }
+    state[type] = 2;
+}
+
+bool ClassHierarchy::isSubclassOf(boost::string_view type_name, boost::string_view base_class_name) const
+{
+    StringId type, base;
+    if(!names.find(type_name, type) || !names.find(base_class_name, base) || type >= ancestors.size() ||
+       base_bits[base] == no_base_bit)
+        return false;
+    return ancestors[type].test(base_bits[base]);
+}
+
+void ClassHierarchy::getSubclasses(boost::string_view base_class_name, std::vector<std::string>& classes) const
+{
+    StringId base;
+    if(!names.find(base_class_name, base) || base >= base_bits.size() || base_bits[base] == no_base_bit)
+        return;
+    const std::vector<StringId>& base_subclasses = subclasses[base_bits[base]];
+    classes.reserve(classes.size() + base_subclasses.size());
+    for(StringId type : base_subclasses)
+        classes.push_back(names.get(type));
+}
+
+void ClassHierarchy::clear()
+{
+    names.clear();
+    direct_bases.clear();
+    is_class.clear();
+    base_bits.clear();
+    ancestors.clear();
+    subclasses.clear();
+}
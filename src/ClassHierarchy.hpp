@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/dynamic_bitset.hpp>
+#include <boost/utility/string_view.hpp>
+#include "StringPool.hpp"
+
+namespace plugin_manager
+{
+
+/**
+ * @class ClassHierarchy
+ * @brief The transitive closure of the base class relations of the plugin classes and of
+ *        the relations declared in the xml files.
+ * Each type is interned once, the ancestors of a type are stored as a bitset over all types
+ * that are used as base class. After update the queries don't walk the hierarchy.
+ */
+class ClassHierarchy
+{
+public:
+    /**
+     * @brief Adds a plugin class and its direct base class
+     */
+    void addClass(boost::string_view class_name, boost::string_view base_class_name);
+
+    /**
+     * @brief Adds a declared relation between two types, the type isn't a plugin class itself
+     */
+    void addBaseClass(boost::string_view type_name, boost::string_view base_class_name);
+
+    /**
+     * @brief Computes the transitive closure, has to be called after all relations were added
+     */
+    void update();
+
+    /**
+     * @brief Returns true if the type inherits directly or indirectly from the base class
+     */
+    bool isSubclassOf(boost::string_view type_name, boost::string_view base_class_name) const;
+
+    /**
+     * @brief Returns the plugin classes which inherit directly or indirectly from the base class
+     * @param base_class_name the name of the base class
+     * @param classes the full class names are appended in sorted order
+     */
+    void getSubclasses(boost::string_view base_class_name, std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Removes all types and relations
+     */
+    void clear();
+
+private:
+    /** Adds the relation, the type ids are the ids in the name pool */
+    void addRelation(boost::string_view type_name, boost::string_view base_class_name, bool is_class);
+
+    /** Computes the ancestors of a type and of all its bases */
+    void computeAncestors(StringId type, std::vector<uint8_t>& state);
+
+    /** Names of all types, the ids are used as type index */
+    StringPool names;
+
+    /** Direct base classes of each type */
+    std::vector< std::vector<StringId> > direct_bases;
+
+    /** True if the type is a plugin class */
+    std::vector<bool> is_class;
+
+    /** Bit of each type in the ancestor bitsets, types which are no base class have none */
+    std::vector<uint32_t> base_bits;
+
+    /** All direct and indirect base classes of each type */
+    std::vector< boost::dynamic_bitset<uint64_t> > ancestors;
+
+    /** All plugin classes inheriting from a base class, indexed by bit, sorted by name */
+    std::vector< std::vector<StringId> > subclasses;
+};
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <boost/utility/string_view.hpp>
+#include "StringPool.hpp"
+
+namespace plugin_manager
+{
+
+/**
+ * @class ClassName
+ * @brief A class name together with its hash, see PluginManager::resolve.
+ * Created with PLUGIN_CLASS or the _plugin_class literal the hash is computed at compile time,
+ * a lookup with it only compares the name with the registered class of the same hash.
+ * Whether the name is in canonical form, see TypeName, is also decided once when it is created.
+ * The class doesn't own the name, it is meant for string literals.
+ */
+class ClassName
+{
+public:
+    /**
+     * @brief Creates a class name and computes its hash
+     */
+    constexpr ClassName(const char* name, size_t length) :
+        name(name), length(length), hash(StringPool::hashString(name, length)), canonical(isCanonical(name, length)) {}
+
+    /**
+     * @brief Creates a class name with a precomputed hash, see StringPool::hashString
+     */
+    constexpr ClassName(const char* name, size_t length, uint64_t hash) :
+        name(name), length(length), hash(hash), canonical(isCanonical(name, length)) {}
+
+    /**
+     * @brief Creates a class name with a precomputed hash and canonical form, see PLUGIN_CLASS
+     */
+    constexpr ClassName(const char* name, size_t length, uint64_t hash, bool canonical) :
+        name(name), length(length), hash(hash), canonical(canonical) {}
+
+    /**
+     * @brief Returns the class name
+     */
+    boost::string_view getName() const { return boost::string_view(name, length); }
+
+    /**
+     * @brief Returns the hash of the class name
+     */
+    constexpr uint64_t getHash() const { return hash; }
+
+    /**
+     * @brief Returns true if the name is in canonical form, only then the hash can be used for lookups
+     */
+    constexpr bool isCanonical() const { return canonical; }
+
+    /**
+     * @brief Returns true if the name has no whitespace except a single space between two words,
+     * like TypeName::isCanonical. It can be evaluated at compile time.
+     */
+    static constexpr bool isCanonical(const char* name, size_t length, size_t i = 0)
+    {
+        return i >= length ? true :
+               isSpace(name[i]) && (name[i] != ' ' || i == 0 || i + 1 == length || !isWordChar(name[i - 1]) || !isWordChar(name[i + 1])) ? false :
+               isCanonical(name, length, i + 1);
+    }
+
+private:
+    static constexpr bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    static constexpr bool isWordChar(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    const char* name;
+    size_t length;
+    uint64_t hash;
+    bool canonical;
+};
+
+namespace literals
+{
+
+/**
+ * @brief Creates a class name from a string literal, e.g. "envire::core::ItemBase"_plugin_class
+ */
+constexpr ClassName operator"" _plugin_class(const char* name, size_t length)
+{
+    return ClassName(name, length);
+}
+
+}
+
+}
+
+/**
+ * @brief Creates a ClassName from a string literal, the hash and the canonical form are always checked at compile time
+ */
+#define PLUGIN_CLASS(name) \
+    (::plugin_manager::ClassName(name, sizeof(name) - 1, \
+        std::integral_constant<uint64_t, ::plugin_manager::StringPool::hashString(name, sizeof(name) - 1)>::value, \
+        std::integral_constant<bool, ::plugin_manager::ClassName::isCanonical(name, sizeof(name) - 1)>::value))
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <stddef.h>
+#include <boost/noncopyable.hpp>
+
+namespace plugin_manager
+{
+
+/**
+ * @class CopyOnWriteMap
+ * @brief A map for read mostly data which can be searched without taking a lock.
+ * Each insert publishes a new copy of the map by replacing an atomic pointer, readers
+ * only load this pointer. The replaced copy is deleted as soon as no reader can still be
+ * searching it: readers announce themselves in one of two reader epochs, the writer switches
+ * the epoch and waits until the readers of the previous epoch are done. The reader counters
+ * are spread over several cache lines, so readers on different cores don't contend.
+ * The map is meant for a small number of entries which are inserted once and read very
+ * often, e.g. loaded libraries.
+ */
+template<class Key, class Value>
+class CopyOnWriteMap : public boost::noncopyable
+{
+public:
+    typedef std::map<Key, Value> Map;
+
+    CopyOnWriteMap() : current(new Map()), epoch(0)
+    {
+        for(size_t i = 0; i < 2 * reader_slots; i++)
+            readers[i].count = 0;
+    }
+
+    ~CopyOnWriteMap()
+    {
+        delete current.load();
+    }
+
+    /**
+     * @brief Searches the map, this never blocks
+     * @param key the key to search for
+     * @param value the value stored for the key
+     * @return True if the key was found
+     */
+    bool find(const Key& key, Value& value) const
+    {
+        ReaderGuard guard(*this);
+        const Map* map = current.load();
+        typename Map::const_iterator it = map->find(key);
+        if(it == map->end())
+            return false;
+        value = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Inserts or replaces a value and publishes a new copy of the map.
+     * Concurrent inserts are serialized, the call waits until readers of the replaced copy are done.
+     * @param key the key of the value
+     * @param value the value to store
+     */
+    void insert(const Key& key, const Value& value)
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        std::unique_ptr<Map> map(new Map(*current.load()));
+        (*map)[key] = value;
+        replace(map.release());
+    }
+
+    /**
+     * @brief Removes all values
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        replace(new Map());
+    }
+
+private:
+    /** Number of reader counters per epoch */
+    static const size_t reader_slots = 16;
+
+    /** A reader counter on its own cache line */
+    struct ReaderSlot
+    {
+        std::atomic<size_t> count;
+        char padding[64 - sizeof(std::atomic<size_t>)];
+    };
+
+    /** Registers a reader in the current epoch for its lifetime */
+    class ReaderGuard
+    {
+    public:
+        explicit ReaderGuard(const CopyOnWriteMap& map)
+        {
+            // the epoch is checked again, a writer might have switched it before the reader was counted
+            const size_t slot = threadSlot();
+            for(;;)
+            {
+                const size_t reader_epoch = map.epoch.load();
+                counter = &map.readers[reader_epoch * reader_slots + slot].count;
+                counter->fetch_add(1);
+                if(map.epoch.load() == reader_epoch)
+                    break;
+                counter->fetch_sub(1);
+            }
+        }
+
+        ~ReaderGuard()
+        {
+            counter->fetch_sub(1);
+        }
+
+    private:
+        std::atomic<size_t>* counter;
+    };
+
+    /** Returns the reader slot of the calling thread */
+    static size_t threadSlot()
+    {
+        static std::atomic<size_t> next_slot(0);
+        static thread_local size_t slot = next_slot++ % reader_slots;
+        return slot;
+    }
+
+    /** Publishes a new copy and deletes the replaced one, the write mutex must be held */
+    void replace(const Map* map)
+    {
+        const Map* replaced = current.exchange(map);
+
+        // new readers are counted in the other epoch, so the readers of this one drain
+        const size_t previous_epoch = epoch.load();
+        epoch.store(1 - previous_epoch);
+        for(size_t slot = 0; slot < reader_slots; slot++)
+        {
+            while(readers[previous_epoch * reader_slots + slot].count.load() != 0)
+                std::this_thread::yield();
+        }
+        delete replaced;
+    }
+
+    /** The latest copy of the map */
+    std::atomic<const Map*> current;
+
+    /** The epoch new readers are counted in, either 0 or 1 */
+    std::atomic<size_t> epoch;
+
+    /** Number of active readers per epoch and slot */
+    mutable ReaderSlot readers[2 * reader_slots];
+
+    /** Serializes inserts */
+    std::mutex write_mutex;
+};
+
+}
@@ -0,0 +1,112 @@
+#include "DirectoryScanner.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <boost/algorithm/string.hpp>
+
+using namespace plugin_manager;
+
+DirectoryScanner::DirectoryScanner(const std::string& extension, bool unique_files) : extension(extension), unique_files(unique_files)
+{
+}
+
+void DirectoryScanner::scan(const std::string& path, std::vector<std::string>* new_files)
+{
+    struct stat path_stat;
+    if(path.empty() || stat(path.c_str(), &path_stat) != 0)
+        return;
+
+    if(S_ISREG(path_stat.st_mode))
+    {
+        // the search path is actualy a file
+        if(hasExtension(path.c_str()))
+            addFile(FileId(path_stat.st_dev, path_stat.st_ino), path, new_files);
+        return;
+    }
+    if(!S_ISDIR(path_stat.st_mode))
+        return;
+
+    // folders reachable through several search paths are read only once
+    if(!scanned_folders.insert(FileId(path_stat.st_dev, path_stat.st_ino)).second)
+        return;
+
+    DIR* folder = opendir(path.c_str());
+    if(folder == NULL)
+        return;
+
+    std::string folder_path = path;
+    boost::trim_right_if(folder_path, boost::is_any_of("/"));
+    folder_path += '/';
+
+    for(struct dirent* entry = readdir(folder); entry != NULL; entry = readdir(folder))
+    {
+        if(entry->d_type == DT_DIR || !hasExtension(entry->d_name))
+            continue;
+
+        // the identity is always taken from stat, on overlay, bind and some FUSE mounts the inode
+        // of the directory entry and the device of the folder differ from the ones of the file
+        struct stat file_stat;
+        if(fstatat(dirfd(folder), entry->d_name, &file_stat, 0) == 0 && S_ISREG(file_stat.st_mode))
+            addFile(FileId(file_stat.st_dev, file_stat.st_ino), folder_path + entry->d_name, new_files);
+    }
+    closedir(folder);
+}
+
+const std::set<std::string>& DirectoryScanner::getFiles() const
+{
+    return files;
+}
+
+bool DirectoryScanner::isKnownFile(const std::string& path) const
+{
+    struct stat file_stat;
+    if(stat(path.c_str(), &file_stat) != 0)
+        return false;
+    return found_files.count(FileId(file_stat.st_dev, file_stat.st_ino)) != 0;
+}
+
+std::vector<std::string> DirectoryScanner::splitPathList(const std::string& path_list)
+{
+    std::vector<std::string> split_paths;
+    //":" is the separator in LD_LIBRARY_PATH
+    boost::split(split_paths, path_list, boost::is_any_of(":"));
+
+    std::vector<std::string> paths;
+    for(std::string& path : split_paths)
+    {
+        //trim " " from the beginning and end of the string
+        boost::trim_if(path, boost::is_any_of(" "));
+        boost::trim_right_if(path, boost::is_any_of("/"));
+        if(!path.empty())
+            paths.push_back(path);
+    }
+    return paths;
+}
+
+std::vector<std::string> DirectoryScanner::getLibraryPathsFromEnv()
+{
+    const char* library_paths = std::getenv("LD_LIBRARY_PATH");
+    if(library_paths == NULL)
+        return std::vector<std::string>();
+    return splitPathList(library_paths);
+}
+
+bool DirectoryScanner::hasExtension(const char* name) const
+{
+    size_t length = strlen(name);
+    return length >= extension.size() && strcasecmp(name + length - extension.size(), extension.c_str()) == 0;
+}
+
+void DirectoryScanner::addFile(const FileId& id, const std::string& path, std::vector<std::string>* new_files)
+{
+    // the same file is only reported once, for the first path it was found at
+    if(!found_files.insert(id).second && unique_files)
+        return;
+    if(!files.insert(path).second)
+        return;
+    if(new_files != NULL)
+        new_files->push_back(path);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+#include <utility>
+#include <sys/types.h>
+
+namespace plugin_manager
+{
+
+/**
+ * @class DirectoryScanner
+ * @brief Collects the files with a given extension from a list of search paths.
+ * Search paths and files are identified by their device and inode, so folders
+ * which are listed several times or are reachable through symbolic links are only
+ * read once and the same file is only reported for the first path it was found at.
+ * Each folder is read in a single pass, only entries with the extension are resolved with
+ * fstatat relative to the folder. The identity of a file is always taken from stat, since
+ * the inode of a directory entry can differ from it on overlay and FUSE file systems.
+ * Sub folders are not scanned.
+ */
+class DirectoryScanner
+{
+public:
+    /**
+     * @brief Constructor for DirectoryScanner
+     * @param extension the file extension to look for including the dot, it is compared case insensitive
+     * @param unique_files if false every name of a file is reported, e.g. each symbolic link to a library.
+     *        Folders are read once in both cases.
+     */
+    DirectoryScanner(const std::string& extension, bool unique_files = true);
+
+    /**
+     * @brief Scans a search path, which can be a folder or a single file.
+     *        Search paths that don't exist are ignored.
+     * @param path the search path
+     * @param new_files if given the files which were found by this call are added to it
+     */
+    void scan(const std::string& path, std::vector<std::string>* new_files = NULL);
+
+    /**
+     * @brief Returns the files found so far
+     */
+    const std::set<std::string>& getFiles() const;
+
+    /**
+     * @brief Returns true if the given path refers to a file that was already found,
+     *        possibly under a different path
+     */
+    bool isKnownFile(const std::string& path) const;
+
+    /**
+     * @brief Splits a colon separated list of paths, like the LD_LIBRARY_PATH.
+     *        Surrounding white space and trailing slashes are removed, empty entries are skipped.
+     * @param path_list the list of paths
+     * @return A vector of paths
+     */
+    static std::vector<std::string> splitPathList(const std::string& path_list);
+
+    /**
+     * @brief Returns the paths set in the environment variable LD_LIBRARY_PATH
+     */
+    static std::vector<std::string> getLibraryPathsFromEnv();
+
+private:
+    typedef std::pair<dev_t, ino_t> FileId;
+
+    bool hasExtension(const char* name) const;
+
+    void addFile(const FileId& id, const std::string& path, std::vector<std::string>* new_files);
+
+    std::string extension;
+    bool unique_files;
+    std::set<FileId> scanned_folders;
+    std::set<FileId> found_files;
+    std::set<std::string> files;
+};
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <class_loader/class_loader.h>
+
+namespace plugin_manager
+{
+
+class PluginLoader;
+
+/**
+ * @class Factory
+ * @brief Creates instances of a single plugin class, see PluginLoader::getFactory.
+ * The library, the name the class is registered with and the singleton policy are resolved
+ * once when the factory is created, calling the factory only constructs the instance.
+ * The factory keeps the library loaded and, for singleton classes, the singleton instance.
+ * A factory can be copied and called from many threads.
+ */
+template<class BaseClass>
+class Factory
+{
+    friend class PluginLoader;
+
+public:
+    /**
+     * @brief Creates an invalid factory
+     */
+    Factory() {}
+
+    /**
+     * @brief Returns true if the factory can create instances
+     */
+    bool isValid() const { return loader.get() != NULL || singleton_instance.get() != NULL; }
+
+    /**
+     * @brief Returns the name the class is registered with in its library
+     */
+    const std::string& getClassName() const { return class_name; }
+
+    /**
+     * @brief Creates a new instance of the class, or returns the instance of a singleton class
+     * @return The instance, NULL if the factory is invalid
+     */
+    boost::shared_ptr<BaseClass> operator()() const
+    {
+        if(singleton_instance)
+            return singleton_instance;
+        if(!loader)
+            return boost::shared_ptr<BaseClass>();
+        return loader->createInstance<BaseClass>(class_name);
+    }
+
+private:
+    Factory(const boost::shared_ptr<class_loader::ClassLoader>& loader, const std::string& class_name) :
+            loader(loader), class_name(class_name) {}
+
+    Factory(const boost::shared_ptr<BaseClass>& singleton_instance, const std::string& class_name) :
+            class_name(class_name), singleton_instance(singleton_instance) {}
+
+    /** The class loader of the library, NULL for singleton classes */
+    boost::shared_ptr<class_loader::ClassLoader> loader;
+
+    /** Name of the class in the library */
+    std::string class_name;
+
+    /** The instance of a singleton class */
+    boost::shared_ptr<BaseClass> singleton_instance;
+};
+
+}
@@ -0,0 +1,82 @@
+#include "NodeArena.hpp"
+#include <new>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace plugin_manager;
+
+static const size_t node_alignment = 2 * sizeof(void*);
+
+NodeArena::NodeArena(size_t block_size) : block_size(alignSize(block_size)), reserved_bytes(0), current(NULL), remaining(0)
+{
+}
+
+NodeArena::~NodeArena()
+{
+    release();
+}
+
+size_t NodeArena::alignSize(size_t size)
+{
+    if(size == 0)
+        size = 1;
+    return (size + node_alignment - 1) / node_alignment * node_alignment;
+}
+
+void* NodeArena::allocate(size_t size)
+{
+    size = alignSize(size);
+    size_t list = size / node_alignment;
+    if(list < free_lists.size() && free_lists[list] != NULL)
+    {
+        FreeNode* node = free_lists[list];
+        free_lists[list] = node->next;
+        return node;
+    }
+
+    if(size > remaining)
+    {
+        // the rest of the current block is dropped, nodes are small compared to a block
+        size_t new_block_size = std::max(size, block_size);
+        char* block = static_cast<char*>(std::malloc(new_block_size));
+        if(block == NULL)
+            throw std::bad_alloc();
+        blocks.push_back(block);
+        reserved_bytes += new_block_size;
+        current = block;
+        remaining = new_block_size;
+    }
+
+    void* node = current;
+    current += size;
+    remaining -= size;
+    return node;
+}
+
+void NodeArena::deallocate(void* node, size_t size)
+{
+    if(node == NULL)
+        return;
+    size_t list = alignSize(size) / node_alignment;
+    if(list >= free_lists.size())
+        free_lists.resize(list + 1, NULL);
+    FreeNode* free_node = static_cast<FreeNode*>(node);
+    free_node->next = free_lists[list];
+    free_lists[list] = free_node;
+}
+
+void NodeArena::release()
+{
+    for(char* block : blocks)
+        std::free(block);
+    blocks.clear();
+    free_lists.clear();
+    reserved_bytes = 0;
+    current = NULL;
+    remaining = 0;
+}
+
+size_t NodeArena::getReservedBytes() const
+{
+    return reserved_bytes;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+#include <boost/noncopyable.hpp>
+
+namespace plugin_manager
+{
+
+/**
+ * @class NodeArena
+ * @brief Allocates the nodes of the registry indexes from large memory blocks.
+ * Nodes which are given back are kept in free lists per size and reused by the next
+ * allocation of the same size. All blocks are freed at once by release().
+ */
+class NodeArena : public boost::noncopyable
+{
+public:
+    /**
+     * @brief Constructor for NodeArena
+     * @param block_size size of the memory blocks in bytes
+     */
+    NodeArena(size_t block_size = 16384);
+
+    /**
+     * @brief Destructor, frees all blocks
+     */
+    ~NodeArena();
+
+    /**
+     * @brief Returns memory of the given size, aligned for any fundamental type
+     */
+    void* allocate(size_t size);
+
+    /**
+     * @brief Gives back memory returned by allocate, it is reused for allocations of the same size
+     */
+    void deallocate(void* node, size_t size);
+
+    /**
+     * @brief Frees all blocks at once, all memory returned so far becomes invalid
+     */
+    void release();
+
+    /**
+     * @brief Returns the number of bytes of the allocated blocks
+     */
+    size_t getReservedBytes() const;
+
+private:
+    struct FreeNode
+    {
+        FreeNode* next;
+    };
+
+    /** Rounds a size up to the alignment of the nodes */
+    static size_t alignSize(size_t size);
+
+    size_t block_size;
+    std::vector<char*> blocks;
+    size_t reserved_bytes;
+    char* current;
+    size_t remaining;
+
+    /** Free lists indexed by aligned size divided by the alignment */
+    std::vector<FreeNode*> free_lists;
+};
+
+/**
+ * @brief Standard allocator which takes its memory from a NodeArena.
+ * It is meant for node based containers, the arena has to outlive the container.
+ */
+template<class T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(NodeArena* arena) : arena(arena) {}
+
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        arena->deallocate(p, n * sizeof(T));
+    }
+
+    NodeArena* arena;
+};
+
+template<class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return a.arena == b.arena;
+}
+
+template<class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return a.arena != b.arena;
+}
+
+}
@@ -0,0 +1,315 @@
+#include "PluginDirectoryWatcher.hpp"
+#include "PluginManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string.hpp>
+#include <glog/logging.h>
+
+using namespace plugin_manager;
+
+static const uint32_t watch_mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE |
+                                   IN_DELETE_SELF | IN_MOVE_SELF;
+
+PluginDirectoryWatcher::PluginDirectoryWatcher(PluginManager& plugin_manager, unsigned int debounce_ms) :
+    plugin_manager(plugin_manager), debounce_ms(debounce_ms), inotify_fd(-1), wakeup_fd(-1), next_subscription_id(0)
+{
+}
+
+PluginDirectoryWatcher::~PluginDirectoryWatcher()
+{
+    stop();
+}
+
+bool PluginDirectoryWatcher::start()
+{
+    if(isRunning())
+        return true;
+
+    inotify_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if(inotify_fd < 0)
+    {
+        LOG(ERROR) << "Failed to initialize inotify: " << strerror(errno);
+        return false;
+    }
+    wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if(wakeup_fd < 0)
+    {
+        LOG(ERROR) << "Failed to create eventfd: " << strerror(errno);
+        close(inotify_fd);
+        inotify_fd = -1;
+        return false;
+    }
+
+    addWatches();
+    if(watches.empty())
+        LOG(WARNING) << "None of the plugin xml paths can be watched.";
+
+    watcher_thread = std::thread(&PluginDirectoryWatcher::run, this);
+    return true;
+}
+
+void PluginDirectoryWatcher::stop()
+{
+    if(!isRunning())
+        return;
+
+    uint64_t wakeup = 1;
+    if(write(wakeup_fd, &wakeup, sizeof(wakeup)) != sizeof(wakeup))
+        LOG(ERROR) << "Failed to wake up the plugin directory watcher thread: " << strerror(errno);
+    watcher_thread.join();
+
+    close(inotify_fd);
+    close(wakeup_fd);
+    inotify_fd = -1;
+    wakeup_fd = -1;
+    watches.clear();
+}
+
+bool PluginDirectoryWatcher::isRunning() const
+{
+    return watcher_thread.joinable();
+}
+
+unsigned int PluginDirectoryWatcher::subscribe(const std::string& base_class, const Callback& callback)
+{
+    std::lock_guard<std::mutex> lock(subscription_mutex);
+    Subscription subscription;
+    subscription.base_class = base_class;
+    subscription.callback = callback;
+    subscriptions[next_subscription_id] = subscription;
+    return next_subscription_id++;
+}
+
+void PluginDirectoryWatcher::unsubscribe(unsigned int subscription_id)
+{
+    std::lock_guard<std::mutex> lock(subscription_mutex);
+    subscriptions.erase(subscription_id);
+}
+
+std::mutex& PluginDirectoryWatcher::getUpdateMutex()
+{
+    return update_mutex;
+}
+
+void PluginDirectoryWatcher::addWatches()
+{
+    for(const std::pair<const int, WatchedFolder>& watch : watches)
+        inotify_rm_watch(inotify_fd, watch.first);
+    watches.clear();
+
+    std::vector<std::string> plugin_xml_paths;
+    {
+        std::lock_guard<std::mutex> lock(update_mutex);
+        plugin_xml_paths = plugin_manager.getPluginXmlPaths();
+    }
+
+    for(std::string path : plugin_xml_paths)
+    {
+        boost::trim_right_if(path, boost::is_any_of("/"));
+        if(path.empty())
+            continue;
+
+        // files and folders that don't exist yet are watched through their parent folder
+        boost::filesystem::path folder(path);
+        std::string name;
+        if(!boost::filesystem::is_directory(folder))
+        {
+            name = folder.filename().string();
+            folder = folder.parent_path();
+            if(!boost::filesystem::is_directory(folder))
+                continue;
+        }
+
+        int watch_descriptor = inotify_add_watch(inotify_fd, folder.string().c_str(), watch_mask);
+        if(watch_descriptor < 0)
+        {
+            LOG(WARNING) << "Failed to watch plugin xml path " << folder.string() << ": " << strerror(errno);
+            continue;
+        }
+
+        // the same folder can be watched for several entries
+        std::map<int, WatchedFolder>::iterator watch = watches.find(watch_descriptor);
+        if(watch == watches.end())
+        {
+            WatchedFolder watched_folder;
+            watched_folder.folder = folder.string();
+            if(!name.empty())
+                watched_folder.names.insert(name);
+            watches[watch_descriptor] = watched_folder;
+        }
+        else if(name.empty())
+            watch->second.names.clear();
+        else if(!watch->second.names.empty())
+            watch->second.names.insert(name);
+    }
+}
+
+bool PluginDirectoryWatcher::isRelevant(int watch_descriptor, const std::string& name) const
+{
+    std::map<int, WatchedFolder>::const_iterator watch = watches.find(watch_descriptor);
+    if(watch == watches.end())
+        return false;
+
+    if(!watch->second.names.empty())
+        return watch->second.names.count(name) != 0;
+
+    std::string extension = boost::filesystem::path(name).extension().string();
+    boost::algorithm::to_lower(extension);
+    return extension == ".xml";
+}
+
+void PluginDirectoryWatcher::run()
+{
+    typedef std::chrono::steady_clock Clock;
+    const std::chrono::milliseconds debounce_time(debounce_ms);
+
+    // the event buffer must be aligned for struct inotify_event
+    std::vector<uint64_t> buffer(8192);
+    bool update_pending = false;
+    bool rewatch_pending = false;
+    Clock::time_point deadline;
+    Clock::time_point max_deadline;
+
+    while(true)
+    {
+        int timeout = -1;
+        if(update_pending)
+        {
+            // update once no further events arrived within the debounce time,
+            // but don't delay it forever if the events don't stop
+            Clock::time_point next = std::min(deadline, max_deadline);
+            Clock::time_point now = Clock::now();
+            if(now >= next)
+            {
+                if(rewatch_pending)
+                    addWatches();
+                update();
+                update_pending = false;
+                rewatch_pending = false;
+                continue;
+            }
+            timeout = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1;
+        }
+
+        struct pollfd fds[2];
+        fds[0].fd = inotify_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = wakeup_fd;
+        fds[1].events = POLLIN;
+        int result = poll(fds, 2, timeout);
+        if(result < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            LOG(ERROR) << "Failed to wait for plugin directory events: " << strerror(errno);
+            return;
+        }
+
+        // stop was requested
+        if(fds[1].revents != 0)
+            return;
+
+        if(result == 0)
+            continue;
+
+        ssize_t length = read(inotify_fd, &buffer.front(), buffer.size() * sizeof(uint64_t));
+        if(length <= 0)
+            continue;
+
+        bool relevant = false;
+        const char* data = reinterpret_cast<const char*>(&buffer.front());
+        for(const char* ptr = data; ptr < data + length; )
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if(event->mask & IN_Q_OVERFLOW)
+            {
+                // events have been lost, reload everything
+                relevant = true;
+                rewatch_pending = true;
+            }
+            else if(watches.count(event->wd) == 0)
+                continue;
+            else if(event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+            {
+                relevant = true;
+                rewatch_pending = true;
+            }
+            else if(event->len > 0 && isRelevant(event->wd, event->name))
+            {
+                // new files are handled once they are closed after writing
+                if((event->mask & IN_CREATE) && !(event->mask & IN_ISDIR))
+                    continue;
+                relevant = true;
+                // a watched file or folder appeared in a parent folder
+                if(!watches[event->wd].names.empty())
+                    rewatch_pending = true;
+            }
+        }
+
+        if(relevant)
+        {
+            Clock::time_point now = Clock::now();
+            if(!update_pending)
+                max_deadline = now + 10 * debounce_time;
+            deadline = now + debounce_time;
+            update_pending = true;
+        }
+    }
+}
+
+void PluginDirectoryWatcher::update()
+{
+    std::vector<Subscription> current_subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(subscription_mutex);
+        for(const std::pair<const unsigned int, Subscription>& subscription : subscriptions)
+            current_subscriptions.push_back(subscription.second);
+    }
+
+    std::map<std::string, std::vector<std::string> > classes_before;
+    std::map<std::string, std::vector<std::string> > classes_after;
+    {
+        std::lock_guard<std::mutex> lock(update_mutex);
+        for(const Subscription& subscription : current_subscriptions)
+            classes_before[subscription.base_class] = plugin_manager.getAvailableClasses(subscription.base_class);
+
+        plugin_manager.reloadXMLPluginFiles();
+
+        for(const Subscription& subscription : current_subscriptions)
+            classes_after[subscription.base_class] = plugin_manager.getAvailableClasses(subscription.base_class);
+    }
+
+    // the callbacks are called without holding the update mutex, so they can query the plugin manager
+    for(const Subscription& subscription : current_subscriptions)
+    {
+        std::vector<std::string>& before = classes_before[subscription.base_class];
+        std::vector<std::string>& after = classes_after[subscription.base_class];
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+
+        std::vector<std::string> added_classes;
+        std::vector<std::string> removed_classes;
+        std::set_difference(after.begin(), after.end(), before.begin(), before.end(), std::back_inserter(added_classes));
+        std::set_difference(before.begin(), before.end(), after.begin(), after.end(), std::back_inserter(removed_classes));
+        if(added_classes.empty() && removed_classes.empty())
+            continue;
+
+        try
+        {
+            subscription.callback(subscription.base_class, added_classes, removed_classes);
+        }
+        catch(const std::exception& e)
+        {
+            LOG(ERROR) << "Plugin directory watcher callback for base class " << subscription.base_class << " failed: " << e.what();
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <boost/noncopyable.hpp>
+
+namespace plugin_manager
+{
+
+class PluginManager;
+
+/**
+ * @class PluginDirectoryWatcher
+ * @brief Watches the plugin xml paths of a PluginManager using inotify
+ * and updates the plugin informations when xml files are added, changed or removed.
+ * Events are collected on a background thread and debounced, afterwards
+ * the registry is updated by an incremental reload.
+ * Note: The PluginManager itself isn't synchronized. Threads that query the
+ *       plugin manager while the watcher is running must hold the update mutex.
+ */
+class PluginDirectoryWatcher : public boost::noncopyable
+{
+public:
+    /**
+     * Called if classes of the subscribed base class appear or disappear.
+     * The arguments are the base class name, the added and the removed class names.
+     */
+    typedef std::function<void (const std::string&, const std::vector<std::string>&,
+                                const std::vector<std::string>&)> Callback;
+
+    /**
+     * @brief Constructor for PluginDirectoryWatcher
+     * @param plugin_manager the plugin manager to update, it must outlive the watcher
+     * @param debounce_ms time in milliseconds without further events before the registry is updated
+     */
+    PluginDirectoryWatcher(PluginManager& plugin_manager, unsigned int debounce_ms = 200);
+
+    /**
+     * @brief Destructor, stops the watcher thread
+     */
+    ~PluginDirectoryWatcher();
+
+    /**
+     * @brief Starts watching the current plugin xml paths of the plugin manager
+     * @return True if the watcher thread could be started
+     */
+    bool start();
+
+    /**
+     * @brief Stops watching and joins the watcher thread
+     */
+    void stop();
+
+    /**
+     * @brief Returns true if the watcher thread is running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Registers a callback which is called from the watcher thread
+     *        after an update changed the classes of the given base class.
+     * @param base_class name of the base class
+     * @param callback the callback function
+     * @return An id which can be used to unsubscribe
+     */
+    unsigned int subscribe(const std::string& base_class, const Callback& callback);
+
+    /**
+     * @brief Removes a callback
+     * @param subscription_id id returned by subscribe
+     */
+    void unsubscribe(unsigned int subscription_id);
+
+    /**
+     * @brief Returns the mutex that is held while the plugin manager is updated
+     */
+    std::mutex& getUpdateMutex();
+
+private:
+    struct Subscription
+    {
+        std::string base_class;
+        Callback callback;
+    };
+
+    struct WatchedFolder
+    {
+        /** The watched folder */
+        std::string folder;
+        /** File or folder names of interest, all xml files if empty */
+        std::set<std::string> names;
+    };
+
+    /**
+     * @brief Adds inotify watches for all plugin xml paths.
+     * Paths that are files or don't exist yet are watched through their parent folder.
+     */
+    void addWatches();
+
+    /**
+     * @brief Returns true if the given event name is relevant for the watch
+     */
+    bool isRelevant(int watch_descriptor, const std::string& name) const;
+
+    /**
+     * @brief The watcher thread, reads and debounces events
+     */
+    void run();
+
+    /**
+     * @brief Reloads the plugin informations and informs the subscribers
+     */
+    void update();
+
+    PluginManager& plugin_manager;
+    unsigned int debounce_ms;
+
+    int inotify_fd;
+    int wakeup_fd;
+    std::thread watcher_thread;
+
+    /** Mapping between watch descriptor and the watched folder */
+    std::map<int, WatchedFolder> watches;
+
+    std::mutex update_mutex;
+    std::mutex subscription_mutex;
+    std::map<unsigned int, Subscription> subscriptions;
+    unsigned int next_subscription_id;
+};
+
+}
@@ -1,17 +1,32 @@
 #pragma once
 
 #include <string>
+#include <stddef.h>
 #include <vector>
+#include <utility>
+#include "StringPool.hpp"
 
 namespace plugin_manager
 {
 
+/**
+ * An attribute or the text of an element in the meta element of a class. The key is the path of
+ * the element below the meta element, followed by the attribute name for attributes.
+ * E.g. <meta><user_tag frame_name="laser">text</user_tag></meta> results in the attributes
+ * user_tag.frame_name = laser and user_tag = text.
+ */
+typedef std::pair<std::string, std::string> MetaAttribute;
+
 /**
  * Stores the information of a class that can be
  * loaded by class loader.
  */
 struct PluginInfo
 {
+    PluginInfo() : singleton(false), xml_position(0), details_loaded(true),
+                   class_name_id(invalid_string_id), full_class_name_id(invalid_string_id),
+                   base_class_name_id(invalid_string_id), library_path_id(invalid_string_id) {}
+
     /** Name of the class, without namespace if the class has one */
     std::string class_name;
 
@@ -19,6 +34,11 @@ struct PluginInfo
      *  If the class has no namespace this is equal to class_name */
     std::string full_class_name;
 
+    /** Full name of the class as spelled in the xml file, if it differs from the canonical full_class_name.
+     *  E.g. Item<std::vector<int> > is registered as Item<std::vector<int>>, but class_loader only
+     *  knows the spelling the class was registered with. Empty if the spelling is canonical. */
+    std::string xml_class_name;
+
     /** Full name of the base class, this class is inherited from */
     std::string base_class_name;
 
@@ -32,8 +52,28 @@ struct PluginInfo
     /** Description of this plugin class. This field is optional. */
     std::string description;
 
+    /** Attributes of the meta element. This field is optional. */
+    std::vector<MetaAttribute> meta_attributes;
+
     /** Marks the plugin as singleton. This field is optional and false per default. */
     bool singleton;
+
+    /** Path of the xml file this plugin information was loaded from */
+    std::string xml_file;
+
+    /** Byte offset of the class element in the xml file */
+    size_t xml_position;
+
+    /** False if the optional fields, i.e. the description, the associated classes and
+     *  the meta information and attributes, haven't been loaded yet. See PluginManager::setLazyLoading */
+    bool details_loaded;
+
+    /** Ids of the names in the string pool of the PluginManager the plugin info is registered at.
+     *  These are invalid_string_id as long as the plugin info isn't registered. */
+    StringId class_name_id;
+    StringId full_class_name_id;
+    StringId base_class_name_id;
+    StringId library_path_id;
 };
 
 }
\ No newline at end of file
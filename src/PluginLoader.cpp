@@ -1,12 +1,17 @@
 #include "PluginLoader.hpp"
+#include "DirectoryScanner.hpp"
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <glog/logging.h>
 
 using namespace plugin_manager;
 using namespace std;
 
-PluginLoader::PluginLoader(bool auto_load_xml_files) : PluginManager(std::vector<std::string>(), true, auto_load_xml_files)
+PluginLoader::PluginLoader(bool auto_load_xml_files) : PluginManager(std::vector<std::string>(), true, auto_load_xml_files),
+                                                        library_files_indexed(false), resolve_libraries_on_reload(false)
 {
     loadLibraryPaths();
 }
@@ -29,75 +34,208 @@ bool PluginLoader::hasClass(const string& class_name) const
 
 bool PluginLoader::hasClassOfType(const string& class_name, const string& base_class_name) const
 {
-    std::string base_class;
-    if(getBaseClass(class_name, base_class) && base_class == base_class_name)
-        return true;
-    return false;
+    return isClassOfType(class_name, base_class_name);
 }
 
 void PluginLoader::addLibraryPath(const string& library_path)
 {
     string lib_path_trimed = library_path;
     boost::trim_right_if(lib_path_trimed, boost::is_any_of("/"));
-    library_paths.insert(lib_path_trimed);
+    std::lock_guard<std::mutex> lock(library_paths_mutex);
+    if(library_paths.insert(lib_path_trimed).second)
+        library_files_indexed = false;
 }
 
-void PluginLoader::loadLibraryPaths()
+string PluginLoader::getLibraryFile(const string& library_name)
+{
+    std::lock_guard<std::mutex> lock(library_paths_mutex);
+    if(!library_files_indexed)
+        indexLibraryFiles();
+    std::map<std::string, std::string>::const_iterator it = library_files.find(library_name);
+    return it != library_files.end() ? it->second : string();
+}
+
+void PluginLoader::rescanLibraryPaths()
+{
+    std::lock_guard<std::mutex> lock(library_paths_mutex);
+    indexLibraryFiles();
+}
+
+void PluginLoader::setResolveLibrariesOnReload(bool resolve_on_reload)
+{
+    std::lock_guard<std::mutex> lock(library_paths_mutex);
+    resolve_libraries_on_reload = resolve_on_reload;
+}
+
+void PluginLoader::pluginFilesReloaded()
 {
-    const char* lib_path = std::getenv("LD_LIBRARY_PATH");
-    vector<string> paths;
-    if(lib_path != NULL)
     {
-        const string lib_paths(lib_path);
-        //":" is the separator in LD_LIBRARY_PATH
-        boost::split(paths, lib_paths, boost::is_any_of(":"));
-        //trim ":" and " " from the beginning and end of the string
-        for(string& path : paths)
+        std::lock_guard<std::mutex> lock(library_paths_mutex);
+        if(!resolve_libraries_on_reload)
+            return;
+        indexLibraryFiles();
+    }
+
+    std::set<std::string> library_names = getRegisteredLibraries();
+    for(const string& library_name : library_names)
+    {
+        if(getLibraryFile(library_name).empty())
+            LOG(WARNING) << "Couldn't find the plugin library " << library_name << " in the library paths, "
+                         << "its classes can't be instantiated";
+    }
+}
+
+void PluginLoader::indexLibraryFiles()
+{
+    // each folder is read once, a library found in several folders is taken from the first one.
+    // All names of a file are indexed, libraries are often symbolic links to the same file.
+    library_files.clear();
+    DirectoryScanner scanner(".so", false);
+    for(const string& lib_path : library_paths)
+    {
+        vector<string> files;
+        scanner.scan(lib_path, &files);
+        for(const string& file : files)
         {
-            boost::trim_if(path, boost::is_any_of(": "));
-            boost::trim_right_if(path, boost::is_any_of("/"));
-            library_paths.insert(path);
+            string file_name = boost::filesystem::path(file).filename().string();
+            if(file_name.size() <= 6 || !boost::starts_with(file_name, "lib") || !boost::ends_with(file_name, ".so"))
+                continue;
+            string library_name = file_name.substr(3, file_name.size() - 6);
+            library_files.insert(std::make_pair(library_name, boost::filesystem::absolute(file).string()));
         }
     }
+    library_files_indexed = true;
+}
+
+void PluginLoader::loadLibraryPaths()
+{
+    vector<string> paths = DirectoryScanner::getLibraryPathsFromEnv();
+    std::lock_guard<std::mutex> lock(library_paths_mutex);
+    library_paths.insert(paths.begin(), paths.end());
+    library_files_indexed = false;
 }
 
 bool PluginLoader::loadLibrary(const std::string& class_name)
 {
-    if(library_paths.empty())
+    ClassHandle handle = resolve(class_name);
+    if(!handle.isValid())
     {
-        LOG(ERROR) << "Have no valid library paths. Please set LD_LIBRARY_PATH or add an library path manually.";
+        LOG(ERROR) << "Couldn't find library name for given class " << class_name;
         return false;
     }
+    return loadLibrary(handle);
+}
 
-    std::string lib_name;
-    if(!getClassLibraryPath(class_name, lib_name))
+std::future<bool> PluginLoader::preloadLibraries()
+{
+    std::set<std::string> library_names = getRegisteredLibraries();
+    return preloadLibraries(std::vector<std::string>(library_names.begin(), library_names.end()));
+}
+
+std::future<bool> PluginLoader::preloadLibraries(const string& base_class)
+{
+    // the registry is queried by the calling thread, the workers only load the libraries
+    std::set<std::string> library_names;
+    vector<string> classes = getAvailableClasses(base_class, true);
+    for(const string& class_name : classes)
     {
-        LOG(ERROR) << "Couldn't find library name for given class " << class_name;
-        return false;
+        ClassHandle handle = resolve(class_name);
+        if(handle.isValid())
+            library_names.insert(handle.getLibraryPath());
     }
+    return preloadLibraries(std::vector<std::string>(library_names.begin(), library_names.end()));
+}
 
-    // check if the library was already loaded
-    if(loaders.find(lib_name) != loaders.end())
-        return true;
+std::future<bool> PluginLoader::preloadLibraries(const vector<string>& library_names)
+{
+    return std::async(std::launch::async, &PluginLoader::loadLibraries, this, library_names);
+}
 
-    //try to load the plugin from all available paths
-    for(const string& lib_path : library_paths)
+bool PluginLoader::loadLibraries(const vector<string>& library_names)
+{
+    size_t workers = std::max(std::thread::hardware_concurrency(), 1u);
+    workers = std::min(workers, library_names.size());
+
+    std::atomic<size_t> next_library(0);
+    std::atomic<bool> all_loaded(true);
+    auto worker = [&]()
     {
-        string path = lib_path + "/lib" + lib_name + ".so";
-        if(boost::filesystem::exists(path))
+        for(size_t i = next_library++; i < library_names.size(); i = next_library++)
         {
-            boost::shared_ptr<class_loader::ClassLoader> loader;
-            loader.reset(new class_loader::ClassLoader(path, false));
-            if(loader && loader->isLibraryLoaded())
+            if(!loadLibraryByName(library_names[i]))
             {
-                loaders.insert(std::make_pair(lib_name, loader));
-                return true;
+                LOG(ERROR) << "Failed to preload plugin library " << library_names[i];
+                all_loaded = false;
             }
-            else
-                LOG(WARNING) << "Failed to load library in " << path;
         }
+    };
+
+    // the calling thread is one of the workers
+    std::vector< std::future<void> > results;
+    for(size_t i = 1; i < workers; i++)
+        results.push_back(std::async(std::launch::async, worker));
+    worker();
+    for(std::future<void>& result : results)
+        result.get();
+
+    return all_loaded;
+}
+
+bool PluginLoader::loadLibrary(const ClassHandle& handle)
+{
+    if(loadLibraryByName(handle.getLibraryPath()))
+        return true;
+
+    LOG(ERROR) << "Failed to load a plugin library " << handle.getLibraryPath() << " for class " << handle.getFullClassName();
+    return false;
+}
+
+bool PluginLoader::loadLibraryByName(const std::string& lib_name)
+{
+    // check if the library was already loaded
+    boost::shared_ptr<class_loader::ClassLoader> loader;
+    if(loaders.find(lib_name, loader))
+        return true;
+
+    // the library is loaded while holding its own mutex, threads loading other libraries don't wait
+    std::mutex* library_mutex;
+    {
+        std::lock_guard<std::mutex> lock(library_mutexes_mutex);
+        library_mutex = &library_mutexes[lib_name];
+    }
+    std::lock_guard<std::mutex> library_lock(*library_mutex);
+
+    // another thread might have loaded the library meanwhile
+    if(loaders.find(lib_name, loader))
+        return true;
+
+    // libraries missing in the index fail without touching the file system
+    string path;
+    {
+        std::lock_guard<std::mutex> lock(library_paths_mutex);
+        if(library_paths.empty())
+        {
+            LOG(ERROR) << "Have no valid library paths. Please set LD_LIBRARY_PATH or add an library path manually.";
+            return false;
+        }
+        if(!library_files_indexed)
+            indexLibraryFiles();
+        std::map<std::string, std::string>::const_iterator it = library_files.find(lib_name);
+        if(it == library_files.end())
+        {
+            LOG(ERROR) << "Couldn't find the plugin library " << lib_name << " in the library paths";
+            return false;
+        }
+        path = it->second;
+    }
+
+    loader.reset(new class_loader::ClassLoader(path, false));
+    if(loader && loader->isLibraryLoaded())
+    {
+        loaders.insert(lib_name, loader);
+        return true;
     }
 
-    LOG(ERROR) << "Failed to load a plugin library " << lib_name << " for class " << class_name;
+    LOG(WARNING) << "Failed to load library in " << path;
     return false;
 }
\ No newline at end of file
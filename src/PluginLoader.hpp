@@ -1,6 +1,9 @@
 #pragma once
 
 #include <map>
+#include <set>
+#include <mutex>
+#include <future>
 #include <string>
 #include <vector>
 #include <boost/shared_ptr.hpp>
@@ -11,6 +14,9 @@
 
 #include "PluginManager.hpp"
 #include "Exceptions.hpp"
+#include "CopyOnWriteMap.hpp"
+#include "Factory.hpp"
+#include "TypeName.hpp"
 
 namespace plugin_manager
 {
@@ -19,12 +25,17 @@ namespace plugin_manager
  * @class PluginLoader
  * @brief A singleton class used to load class loader based plugins
  * This class inherits from the PluginManager
+ * Instances can be created from many threads. Each library is loaded only once, a thread waiting
+ * for a library to be loaded blocks only until this library is loaded. Creating instances from
+ * libraries that are already loaded doesn't take a lock in the plugin loader.
+ * Note: The registry must not be modified while instances are created, unless the concurrent
+ *       readers mode of the PluginManager is enabled.
  */
 class PluginLoader : public PluginManager, public boost::noncopyable
 {
     friend class base::Singleton<PluginLoader>;
-    typedef std::map<std::string, boost::shared_ptr<class_loader::ClassLoader> > LoaderMap;
-    typedef std::map<std::string, boost::shared_ptr<void> > SingletonMap;
+    typedef CopyOnWriteMap<std::string, boost::shared_ptr<class_loader::ClassLoader> > LoaderMap;
+    typedef CopyOnWriteMap<std::string, boost::shared_ptr<void> > SingletonMap;
 
 public:
     /**
@@ -66,6 +77,94 @@ public:
     template<class InheritedClass, class BaseClass>
     bool createInstance(const std::string& class_name, boost::shared_ptr<InheritedClass>& instance);
 
+    /**
+     * @brief Creates an instance of the given class, e.g. createInstance(PLUGIN_CLASS("StringPlugin"), instance)
+     * @param class_name the name of the plugin class with its precomputed hash
+     * @param instance pointer to the base class of the class
+     * @return True if an instance of the class could be created
+     */
+    template<class BaseClass>
+    bool createInstance(const ClassName& class_name, boost::shared_ptr<BaseClass>& instance);
+
+    /**
+     * @brief Creates an instance of the given class and tries to down cast to the actual implementation.
+     * @param class_name the name of the plugin class with its precomputed hash
+     * @param instance pointer to the instance of the class
+     * @return True if an instance of the class could be created
+     * @throws DownCastException if the cast from BaseClass to InheritedClass isn't possible
+     */
+    template<class InheritedClass, class BaseClass>
+    bool createInstance(const ClassName& class_name, boost::shared_ptr<InheritedClass>& instance);
+
+    /**
+     * @brief Creates an instance of a resolved class, see PluginManager::resolve
+     * @param handle the handle of the plugin class
+     * @param instance pointer to the base class of the class
+     * @return True if an instance of the class could be created
+     */
+    template<class BaseClass>
+    bool createInstance(const ClassHandle& handle, boost::shared_ptr<BaseClass>& instance);
+
+    /**
+     * @brief Creates an instance of a resolved class and tries to down cast to the actual implementation.
+     * @param handle the handle of the plugin class
+     * @param instance pointer to the instance of the class
+     * @return True if an instance of the class could be created
+     * @throws DownCastException if the cast from BaseClass to InheritedClass isn't possible
+     */
+    template<class InheritedClass, class BaseClass>
+    bool createInstance(const ClassHandle& handle, boost::shared_ptr<InheritedClass>& instance);
+
+    /**
+     * @brief Returns a factory for the given class, which creates instances without looking up the class again
+     * @param class_name the name of the plugin class
+     * @return The factory, it is invalid if the class isn't available
+     */
+    template<class BaseClass>
+    Factory<BaseClass> getFactory(const std::string& class_name);
+
+    /**
+     * @brief Returns a factory for the given class, e.g. getFactory<BaseClass>(PLUGIN_CLASS("StringPlugin"))
+     * @param class_name the name of the plugin class with its precomputed hash
+     * @return The factory, it is invalid if the class isn't available
+     */
+    template<class BaseClass>
+    Factory<BaseClass> getFactory(const ClassName& class_name);
+
+    /**
+     * @brief Returns a factory for a resolved class, see PluginManager::resolve
+     * The library is loaded and a singleton instance is created when the factory is created.
+     * @param handle the handle of the plugin class
+     * @return The factory, it is invalid if the class isn't available
+     */
+    template<class BaseClass>
+    Factory<BaseClass> getFactory(const ClassHandle& handle);
+
+    /**
+     * @brief Loads the libraries of all registered classes in the background.
+     * The libraries are opened in parallel by worker threads, so the first instance of a class
+     * can be created without loading its library.
+     * Note: The destructor of the returned future waits until all libraries are loaded.
+     * @return Future which becomes ready when all libraries were processed, its value is true if all could be loaded
+     */
+    std::future<bool> preloadLibraries();
+
+    /**
+     * @brief Loads the libraries of all classes inheriting from the given base class in the background.
+     * See preloadLibraries().
+     * @param base_class the name of the base class
+     * @return Future which becomes ready when all libraries were processed, its value is true if all could be loaded
+     */
+    std::future<bool> preloadLibraries(const std::string& base_class);
+
+    /**
+     * @brief Loads the given libraries in the background.
+     * See preloadLibraries().
+     * @param library_names names of the libraries as used in the xml files, e.g. plugin_manager_test_plugins
+     * @return Future which becomes ready when all libraries were processed, its value is true if all could be loaded
+     */
+    std::future<bool> preloadLibraries(const std::vector<std::string>& library_names);
+
     /**
      * @brief Adds an additional library path to the set of library paths
      * Note: A set of paths is already looked up by using the environment variable LD_LIBRARY_PATH
@@ -74,6 +173,29 @@ public:
      */
     void addLibraryPath(const std::string& library_path);
 
+    /**
+     * @brief Returns the absolute path of a plugin library, as found in the library index.
+     * The library folders are scanned once into an index of library names, which is only updated
+     * if a library path is added, on rescanLibraryPaths and, if enabled, on reloadXMLPluginFiles.
+     * Libraries that aren't in the index can't be loaded.
+     * @param library_name name of the library as used in the xml files, e.g. plugin_manager_test_plugins
+     * @return The absolute path of the library file, an empty string if the library wasn't found
+     */
+    std::string getLibraryFile(const std::string& library_name);
+
+    /**
+     * @brief Scans the library folders again, e.g. if libraries have been installed
+     */
+    void rescanLibraryPaths();
+
+    /**
+     * @brief Sets if the library folders are scanned again on every reloadXMLPluginFiles.
+     * Classes whose library can't be found are reported with a warning after the reload.
+     * This is disabled by default.
+     * @param resolve_on_reload true if the library index is updated on every reload
+     */
+    void setResolveLibrariesOnReload(bool resolve_on_reload);
+
 protected:
     /**
      * @brief Constructor for PluginLoader
@@ -87,6 +209,11 @@ protected:
      */
     virtual ~PluginLoader();
 
+    /**
+     * @brief Updates the library index if enabled, see setResolveLibrariesOnReload
+     */
+    virtual void pluginFilesReloaded();
+
     /**
      * @brief Loads all paths set in the environment variable LD_LIBRARY_PATH
      *        to the set of library paths.
@@ -100,18 +227,56 @@ protected:
      */
     bool loadLibrary(const std::string& class_name);
 
+    /**
+     * @brief Loads the library of a resolved plugin class
+     * @param handle the handle of the plugin class
+     * @return True if the library could be loaded
+     */
+    bool loadLibrary(const ClassHandle& handle);
+
 private:
 
+    /**
+     * @brief Loads the library with the given name if it isn't loaded yet
+     * @param lib_name name of the library
+     * @return True if the library is loaded
+     */
+    bool loadLibraryByName(const std::string& lib_name);
+
+    /**
+     * @brief Loads the given libraries using parallel worker threads
+     * @return True if all libraries could be loaded
+     */
+    bool loadLibraries(const std::vector<std::string>& library_names);
+
+    /**
+     * @brief Scans the library folders into the library index.
+     * The library paths mutex must be held by the caller.
+     */
+    void indexLibraryFiles();
+
+    /**
+     * @brief Finds the class loader of a resolved class and the name the class is registered with
+     * @param handle the handle of the plugin class
+     * @param loader the class loader of the library
+     * @param registered_name the name of the class in the library, as spelled in the xml file
+     * @return True if the class is available in its library
+     */
+    template<class BaseClass>
+    bool findRegisteredClass(const ClassHandle& handle, boost::shared_ptr<class_loader::ClassLoader>& loader,
+                             std::string& registered_name);
+
     /**
      * @brief Uses the class_loader to create a new instance of the given class name.
      *        If the class is marked a singleton, only one instance will be created and
      *        returned on future queries.
      * @param derived_class_name name of the plugin class
+     * @param singleton true if the class is marked as singleton
      * @param loader the class loader
      * @param instance new or singleton instance
      */
     template<class BaseClass>
-    void createInstanceIntern(const std::string& derived_class_name,
+    void createInstanceIntern(const std::string& derived_class_name, bool singleton,
                                 const boost::shared_ptr<class_loader::ClassLoader>& loader,
                                 boost::shared_ptr< BaseClass >& instance);
 
@@ -122,100 +287,217 @@ private:
     /** Singleton instances that have been instantiated */
     SingletonMap singletons;
 
+    /** Serializes the creation of singleton instances */
+    std::mutex singletons_mutex;
+
+    /** One mutex per library, held while the library is loaded */
+    std::map<std::string, std::mutex> library_mutexes;
+
+    /** Guards the map of library mutexes */
+    std::mutex library_mutexes_mutex;
+
     /** Set of the known shared library folders */
     std::set<std::string> library_paths;
+
+    /** Mapping between library name and the absolute path of the library file */
+    std::map<std::string, std::string> library_files;
+
+    /** True if the library index is up to date with the library paths */
+    bool library_files_indexed;
+
+    /** Scan the library folders on every reload of the xml files */
+    bool resolve_libraries_on_reload;
+
+    /** Guards the set of library paths and the library index */
+    std::mutex library_paths_mutex;
 };
 
 template<class BaseClass>
 bool PluginLoader::createInstance(const std::string& class_name, boost::shared_ptr<BaseClass>& instance)
 {
-    // get library name of the class
-    std::string lib_name;
-    if(!getClassLibraryPath(class_name, lib_name))
+    ClassHandle handle = resolve(class_name);
+    if(!handle.isValid())
     {
         LOG(ERROR) << "Could not find plugin library for class " << class_name;
         return false;
     }
+    return createInstance<BaseClass>(handle, instance);
+}
 
-    // find loader for the class
-    LoaderMap::iterator it = loaders.find(lib_name);
-    if(it == loaders.end() && loadLibrary(class_name))
-        it = loaders.find(lib_name);
+template<class InheritedClass, class BaseClass>
+bool PluginLoader::createInstance(const std::string& class_name, boost::shared_ptr<InheritedClass>& instance)
+{
+    boost::shared_ptr<BaseClass> base_instance;
+    if(!createInstance<BaseClass>(class_name, base_instance))
+        return false;
+
+    instance = boost::dynamic_pointer_cast<InheritedClass>(base_instance);
+    if(instance == NULL)
+        throw DownCastException<InheritedClass, BaseClass>(class_name);
+    return true;
+}
 
-    if(it == loaders.end())
+template<class BaseClass>
+bool PluginLoader::createInstance(const ClassName& class_name, boost::shared_ptr<BaseClass>& instance)
+{
+    ClassHandle handle = resolve(class_name);
+    if(!handle.isValid())
     {
-        LOG(ERROR) << "Failed to load plugin library " << lib_name;
+        LOG(ERROR) << "Could not find plugin library for class " << class_name.getName();
         return false;
     }
+    return createInstance<BaseClass>(handle, instance);
+}
 
-    // try to create an instance of the class
-    if(it->second->isClassAvailable<BaseClass>(class_name))
-    {
-        createInstanceIntern<BaseClass>(class_name, it->second, instance);
-        return true;
-    }
+template<class InheritedClass, class BaseClass>
+bool PluginLoader::createInstance(const ClassName& class_name, boost::shared_ptr<InheritedClass>& instance)
+{
+    boost::shared_ptr<BaseClass> base_instance;
+    if(!createInstance<BaseClass>(class_name, base_instance))
+        return false;
 
-    if(hasNamespace(class_name))
-    {
-        // try to create an instance of the class using the class name without namespace
-        std::string short_class_name = removeNamespace(class_name);
-        if(it->second->isClassAvailable<BaseClass>(short_class_name))
-        {
-            createInstanceIntern<BaseClass>(short_class_name, it->second, instance);
-            return true;
-        }
-    }
-    else
+    instance = boost::dynamic_pointer_cast<InheritedClass>(base_instance);
+    if(instance == NULL)
+        throw DownCastException<InheritedClass, BaseClass>(class_name.getName().to_string());
+    return true;
+}
+
+template<class BaseClass>
+bool PluginLoader::createInstance(const ClassHandle& handle, boost::shared_ptr<BaseClass>& instance)
+{
+    if(!handle.isValid())
     {
-        // try to create an instance of the class using the full class name
-        std::string full_class_name;
-        if(getFullClassName(class_name, full_class_name) && it->second->isClassAvailable<BaseClass>(full_class_name))
-        {
-            createInstanceIntern<BaseClass>(full_class_name, it->second, instance);
-            return true;
-        }
+        LOG(ERROR) << "Cannot create an instance of an unresolved class";
+        return false;
     }
 
-    LOG(ERROR) << "Failed to create and instance of class " << class_name
-                << ", it isn't available in the plugin library " << lib_name;
-    return false;
+    boost::shared_ptr<class_loader::ClassLoader> loader;
+    std::string registered_name;
+    if(!findRegisteredClass<BaseClass>(handle, loader, registered_name))
+        return false;
+
+    createInstanceIntern<BaseClass>(registered_name, handle.isSingleton(), loader, instance);
+    return true;
 }
 
 template<class InheritedClass, class BaseClass>
-bool PluginLoader::createInstance(const std::string& class_name, boost::shared_ptr<InheritedClass>& instance)
+bool PluginLoader::createInstance(const ClassHandle& handle, boost::shared_ptr<InheritedClass>& instance)
 {
     boost::shared_ptr<BaseClass> base_instance;
-    if(!createInstance<BaseClass>(class_name, base_instance))
+    if(!createInstance<BaseClass>(handle, base_instance))
         return false;
 
     instance = boost::dynamic_pointer_cast<InheritedClass>(base_instance);
     if(instance == NULL)
-        throw DownCastException<InheritedClass, BaseClass>(class_name);
+        throw DownCastException<InheritedClass, BaseClass>(handle.getFullClassName());
     return true;
 }
 
 template<class BaseClass>
-void PluginLoader::createInstanceIntern(const std::string& derived_class_name,
+Factory<BaseClass> PluginLoader::getFactory(const std::string& class_name)
+{
+    ClassHandle handle = resolve(class_name);
+    if(!handle.isValid())
+    {
+        LOG(ERROR) << "Could not find plugin library for class " << class_name;
+        return Factory<BaseClass>();
+    }
+    return getFactory<BaseClass>(handle);
+}
+
+template<class BaseClass>
+Factory<BaseClass> PluginLoader::getFactory(const ClassName& class_name)
+{
+    ClassHandle handle = resolve(class_name);
+    if(!handle.isValid())
+    {
+        LOG(ERROR) << "Could not find plugin library for class " << class_name.getName();
+        return Factory<BaseClass>();
+    }
+    return getFactory<BaseClass>(handle);
+}
+
+template<class BaseClass>
+Factory<BaseClass> PluginLoader::getFactory(const ClassHandle& handle)
+{
+    if(!handle.isValid())
+    {
+        LOG(ERROR) << "Cannot create a factory of an unresolved class";
+        return Factory<BaseClass>();
+    }
+
+    boost::shared_ptr<class_loader::ClassLoader> loader;
+    std::string registered_name;
+    if(!findRegisteredClass<BaseClass>(handle, loader, registered_name))
+        return Factory<BaseClass>();
+
+    if(handle.isSingleton())
+    {
+        boost::shared_ptr<BaseClass> instance;
+        createInstanceIntern<BaseClass>(registered_name, true, loader, instance);
+        if(!instance)
+            return Factory<BaseClass>();
+        return Factory<BaseClass>(instance, registered_name);
+    }
+    return Factory<BaseClass>(loader, registered_name);
+}
+
+template<class BaseClass>
+bool PluginLoader::findRegisteredClass(const ClassHandle& handle, boost::shared_ptr<class_loader::ClassLoader>& loader,
+                                       std::string& registered_name)
+{
+    // find loader for the class
+    const std::string& lib_name = handle.getLibraryPath();
+    if(!loaders.find(lib_name, loader) && (!loadLibrary(handle) || !loaders.find(lib_name, loader)))
+    {
+        LOG(ERROR) << "Failed to load plugin library " << lib_name;
+        return false;
+    }
+
+    // the class can be registered in the library with or without namespace,
+    // class_loader only knows the spelling of the xml file and not the canonical name
+    const std::string& full_class_name = handle.getRegisteredClassName();
+    if(loader->isClassAvailable<BaseClass>(full_class_name))
+    {
+        registered_name = full_class_name;
+        return true;
+    }
+    TypeName type_name(full_class_name);
+    if(type_name.hasNamespace() && loader->isClassAvailable<BaseClass>(type_name.getTypeWithoutNamespace().to_string()))
+    {
+        registered_name = type_name.getTypeWithoutNamespace().to_string();
+        return true;
+    }
+
+    LOG(ERROR) << "Failed to create and instance of class " << handle.getFullClassName()
+                << ", it isn't available in the plugin library " << lib_name;
+    return false;
+}
+
+template<class BaseClass>
+void PluginLoader::createInstanceIntern(const std::string& derived_class_name, bool singleton,
                                         const boost::shared_ptr<class_loader::ClassLoader>& loader,
                                         boost::shared_ptr< BaseClass >& instance)
 {
-    bool singleton = false;
-    if(getSingletonFlag(derived_class_name, singleton) && singleton)
+    if(singleton)
     {
         // class is marked as singleton
-        SingletonMap::iterator singleton_it = singletons.find(derived_class_name);
-        if(singleton_it == singletons.end())
-        {
-            // create an stores a new instance
-            instance = loader->createInstance<BaseClass>(derived_class_name);
-            boost::shared_ptr< void > instance_ptr = boost::static_pointer_cast<void>(instance);
-            singletons[derived_class_name] = instance_ptr;
-        }
-        else
+        boost::shared_ptr< void > instance_ptr;
+        if(!singletons.find(derived_class_name, instance_ptr))
         {
-            // returns existing instance
-            instance = boost::static_pointer_cast<BaseClass>(singleton_it->second);
+            // check again while holding the lock, another thread might have created the instance meanwhile
+            std::lock_guard<std::mutex> lock(singletons_mutex);
+            if(!singletons.find(derived_class_name, instance_ptr))
+            {
+                // create an stores a new instance
+                instance = loader->createInstance<BaseClass>(derived_class_name);
+                instance_ptr = boost::static_pointer_cast<void>(instance);
+                singletons.insert(derived_class_name, instance_ptr);
+                return;
+            }
         }
+        // returns existing instance
+        instance = boost::static_pointer_cast<BaseClass>(instance_ptr);
     }
     else
     {
@@ -1,17 +1,50 @@
 #include "PluginManager.hpp"
+#include "RegistryCache.hpp"
+#include "PluginXmlParser.hpp"
+#include "DirectoryScanner.hpp"
+#include "RegistrySnapshot.hpp"
+#include "TypeName.hpp"
 #include <tinyxml.h>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
 #include <glog/logging.h>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <sstream>
+#include <sys/mman.h>
+#include <unistd.h>
 
 using namespace plugin_manager;
 
 static const std::string plugin_files_path = "/plugin_manager/";
 static const std::string plugin_file_extension = ".xml";
+static const std::string registry_bundle_name = "plugin_registry.bundle";
 
 PluginManager::PluginManager(const std::vector< std::string >& plugin_xml_paths,
-                             bool load_environment_paths, bool auto_load_xml_files)
+                             bool load_environment_paths, bool auto_load_xml_files,
+                             const std::string& registry_cache_file) :
+                             reload_worker_threads(1), registry_cache_file(registry_cache_file), lazy_loading(false), live_name_count(0),
+                             classes_available(std::less<StringId>(), IndexAllocator(&index_arena)),
+                             classes_by_name(std::less<boost::string_view>(), NameIndexAllocator(&index_arena)),
+                             base_classes_available(std::less<StringId>(), IndexAllocator(&index_arena)),
+                             classes_no_ns_available(std::less<StringId>(), IndexAllocator(&index_arena)),
+                             libraries_available(std::less<StringId>(), IndexAllocator(&index_arena)),
+                             concurrent_readers(false), snapshot_outdated(false), class_hierarchy_outdated(true), change_batch_depth(0), default_meta_callback(NULL)
 {
+#if defined(__GNUC__) && !defined(__clang__)
+    // while this class is constructed its own callback is resolved
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpmf-conversions"
+    default_meta_callback = (MetaInformationCallback)(this->*(&PluginManager::parsePluginMetaInformation));
+#pragma GCC diagnostic pop
+#endif
+
+    const char* shared_registry_name = std::getenv("PLUGIN_MANAGER_SHARED_REGISTRY");
+    if(shared_registry_name != NULL)
+        this->shared_registry_name = shared_registry_name;
+
     std::copy(plugin_xml_paths.begin(), plugin_xml_paths.end(), std::back_inserter(this->plugin_xml_paths));
     if(load_environment_paths)
     {
@@ -36,430 +69,1894 @@ std::vector< std::string > PluginManager::getPluginXmlPaths() const
 std::vector< std::string > PluginManager::getAvailableClasses() const
 {
     std::vector<std::string> classes;
-    classes.reserve(classes_available.size());
-    for(const std::pair<std::string, PluginInfoPtr>& plugin_info : classes_available)
+    if(concurrent_readers)
+    {
+        boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+        if(snapshot)
+            snapshot->getAvailableClasses(classes);
+        return classes;
+    }
+    if(shared_registry)
     {
-        classes.push_back(plugin_info.second->full_class_name);
+        shared_registry->getAvailableClasses(classes);
+        return classes;
     }
+    classes.reserve(classes_by_name.size());
+    for(ClassNameIndex::const_iterator it = classes_by_name.begin(); it != classes_by_name.end(); it++)
+        classes.push_back(it->first.to_string());
     return classes;
 }
 
 std::vector< std::string > PluginManager::getAvailableClasses(const std::string& base_class) const
 {
+    // the registered names are canonical
+    TypeName base_class_type(base_class);
+    if(!base_class_type.isCanonical())
+    {
+        std::string canonical_base_class;
+        base_class_type.appendCanonical(canonical_base_class);
+        return getAvailableClasses(canonical_base_class);
+    }
+
     std::vector<std::string> classes;
-    classes.reserve(base_classes_available.count(base_class));
-    std::pair<std::multimap<std::string, PluginInfoPtr>::const_iterator, std::multimap<std::string, PluginInfoPtr>::const_iterator> range;
-    range = base_classes_available.equal_range(base_class);
-    for(std::multimap<std::string, PluginInfoPtr>::const_iterator it = range.first; it != range.second; it++)
+    if(concurrent_readers)
+    {
+        boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+        if(snapshot)
+            snapshot->getAvailableClasses(base_class, classes);
+        return classes;
+    }
+    if(shared_registry)
+    {
+        shared_registry->getAvailableClasses(base_class, classes);
+        return classes;
+    }
+    StringId base_class_id;
+    if(!names.find(base_class, base_class_id))
+        return classes;
+    classes.reserve(base_classes_available.count(base_class_id));
+    std::pair<ClassMultiIndex::const_iterator, ClassMultiIndex::const_iterator> range;
+    range = base_classes_available.equal_range(base_class_id);
+    for(ClassMultiIndex::const_iterator it = range.first; it != range.second; it++)
     {
-        classes.push_back(it->second->full_class_name);
+        classes.push_back(names.get(records[it->second].full_class_name_id));
     }
+    std::sort(classes.begin(), classes.end());
     return classes;
 }
 
-bool PluginManager::isClassInfoAvailable(const std::string& class_name) const
+std::vector< std::string > PluginManager::getAvailableClasses(const std::string& base_class, bool transitive) const
 {
-    std::string full_class_name;
-    if(getFullClassName(class_name, full_class_name))
-        return true;
-    return false;
+    if(!transitive)
+        return getAvailableClasses(base_class);
+
+    std::vector<std::string> classes;
+    std::string canonical_base_class;
+    boost::string_view base_class_name = TypeName::canonical(base_class, canonical_base_class);
+    if(concurrent_readers)
+    {
+        boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+        if(snapshot)
+            snapshot->getClassHierarchy().getSubclasses(base_class_name, classes);
+        return classes;
+    }
+    getClassHierarchy().getSubclasses(base_class_name, classes);
+    return classes;
+}
+
+bool PluginManager::isSubclassOf(boost::string_view class_name, boost::string_view base_class_name) const
+{
+    return isSubclassOf(resolve(class_name), base_class_name);
 }
 
-bool PluginManager::getBaseClass(const std::string& class_name, std::string& base_class) const
+bool PluginManager::isSubclassOf(const ClassHandle& handle, boost::string_view base_class_name) const
 {
-    std::string full_class_name;
-    if(!getFullClassName(class_name, full_class_name))
+    if(!handle.isValid())
         return false;
+    std::string canonical_base_class_name;
+    base_class_name = TypeName::canonical(base_class_name, canonical_base_class_name);
+    if(concurrent_readers)
+    {
+        boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+        return snapshot && snapshot->getClassHierarchy().isSubclassOf(handle.getFullClassName(), base_class_name);
+    }
+    return getClassHierarchy().isSubclassOf(handle.getFullClassName(), base_class_name);
+}
 
-    std::map<std::string, PluginInfoPtr>::const_iterator plugin_info = classes_available.find(full_class_name);
-    if(plugin_info != classes_available.end())
+bool PluginManager::isClassInfoAvailable(boost::string_view class_name) const
+{
+    if(concurrent_readers)
+        return resolve(class_name).isValid();
+
+    uint32_t class_index;
+    if(shared_registry)
+        return findSharedClass(class_name, class_index);
+    return findClassRecord(class_name) != NULL;
+}
+
+bool PluginManager::getBaseClass(boost::string_view class_name, std::string& base_class) const
+{
+    if(concurrent_readers)
+        return getBaseClass(resolve(class_name), base_class);
+
+    uint32_t class_index;
+    if(shared_registry)
     {
-        base_class = plugin_info->second->base_class_name;
+        if(!findSharedClass(class_name, class_index))
+            return false;
+        base_class = shared_registry->getClassField(class_index, RegistryCache::BASE_CLASS_NAME);
         return true;
     }
-    return false;
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
+        return false;
+    base_class = names.get(record->base_class_name_id);
+    return true;
 }
 
-bool PluginManager::getAssociatedClasses(const std::string& class_name, std::vector<std::string>& associated_classes) const
+bool PluginManager::isClassOfType(boost::string_view class_name, boost::string_view base_class_name) const
 {
-    std::string full_class_name;
-    if(!getFullClassName(class_name, full_class_name))
+    if(concurrent_readers)
+        return isClassOfType(resolve(class_name), base_class_name);
+
+    std::string canonical_name;
+    base_class_name = TypeName::canonical(base_class_name, canonical_name);
+    if(shared_registry)
+    {
+        std::string base_class;
+        return getBaseClass(class_name, base_class) && base_class == base_class_name;
+    }
+
+    // a base class name which isn't in the pool has no classes
+    StringId base_class_name_id;
+    if(!names.find(base_class_name, base_class_name_id))
         return false;
+    const ClassRecord* record = findClassRecord(class_name);
+    return record != NULL && record->base_class_name_id == base_class_name_id;
+}
 
-    std::map<std::string, PluginInfoPtr>::const_iterator plugin_info = classes_available.find(full_class_name);
-    if(plugin_info != classes_available.end())
+bool PluginManager::getAssociatedClasses(boost::string_view class_name, std::vector<std::string>& associated_classes) const
+{
+    if(concurrent_readers)
+        return getAssociatedClasses(resolve(class_name), associated_classes);
+
+    uint32_t class_index;
+    if(shared_registry)
     {
-        if(plugin_info->second->associated_classes.empty())
+        if(!findSharedClass(class_name, class_index))
             return false;
+        std::vector<std::string> shared_associated_classes;
+        if(hasSharedClassDetails(class_index))
+            shared_registry->getAssociatedClasses(class_index, shared_associated_classes);
         else
         {
-            associated_classes = plugin_info->second->associated_classes;
-            return true;
+            PluginInfoPtr plugin_info = getSharedPluginInfo(class_index);
+            ensureClassDetails(plugin_info);
+            shared_associated_classes = plugin_info->associated_classes;
         }
+        if(shared_associated_classes.empty())
+            return false;
+        associated_classes.swap(shared_associated_classes);
+        return true;
+    }
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
+        return false;
+    PluginInfoPtr plugin_info = record->plugin_info;
+    ensureClassDetails(plugin_info);
+    if(plugin_info->associated_classes.empty())
+        return false;
+    else
+    {
+        associated_classes = plugin_info->associated_classes;
+        return true;
     }
-    return false;
 }
 
-bool PluginManager::getClassDescription(const std::string& class_name, std::string& class_description) const
+bool PluginManager::getClassDescription(boost::string_view class_name, std::string& class_description) const
 {
-    std::string full_class_name;
-    if(!getFullClassName(class_name, full_class_name))
-        return false;
+    if(concurrent_readers)
+        return getClassDescription(resolve(class_name), class_description);
 
-    std::map<std::string, PluginInfoPtr>::const_iterator plugin_info = classes_available.find(full_class_name);
-    if(plugin_info != classes_available.end())
+    uint32_t class_index;
+    if(shared_registry)
     {
-        class_description = plugin_info->second->description;
+        if(!findSharedClass(class_name, class_index))
+            return false;
+        if(hasSharedClassDetails(class_index))
+            class_description = shared_registry->getClassField(class_index, RegistryCache::DESCRIPTION);
+        else
+        {
+            PluginInfoPtr plugin_info = getSharedPluginInfo(class_index);
+            ensureClassDetails(plugin_info);
+            class_description = plugin_info->description;
+        }
         return true;
     }
-    return false;
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
+        return false;
+    PluginInfoPtr plugin_info = record->plugin_info;
+    ensureClassDetails(plugin_info);
+    class_description = plugin_info->description;
+    return true;
 }
 
-bool PluginManager::getSingletonFlag(const std::string& class_name, bool& is_singleton) const
+bool PluginManager::getSingletonFlag(boost::string_view class_name, bool& is_singleton) const
 {
-    std::string full_class_name;
-    if(!getFullClassName(class_name, full_class_name))
-        return false;
+    if(concurrent_readers)
+        return getSingletonFlag(resolve(class_name), is_singleton);
 
-    std::map<std::string, PluginInfoPtr>::const_iterator plugin_info = classes_available.find(full_class_name);
-    if(plugin_info != classes_available.end())
+    uint32_t class_index;
+    if(shared_registry)
     {
-        is_singleton = plugin_info->second->singleton;
+        if(!findSharedClass(class_name, class_index))
+            return false;
+        is_singleton = shared_registry->isSingleton(class_index);
         return true;
     }
-    return false;
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
+        return false;
+    is_singleton = record->plugin_info->singleton;
+    return true;
 }
 
-bool PluginManager::getClassLibraryPath(const std::string& class_name, std::string& library_path) const
+bool PluginManager::getClassLibraryPath(boost::string_view class_name, std::string& library_path) const
 {
-    std::string full_class_name;
-    if(!getFullClassName(class_name, full_class_name))
+    if(concurrent_readers)
+        return getClassLibraryPath(resolve(class_name), library_path);
+
+    uint32_t class_index;
+    if(shared_registry)
+    {
+        if(!findSharedClass(class_name, class_index))
+            return false;
+        library_path = shared_registry->getClassField(class_index, RegistryCache::LIBRARY_PATH);
+        return true;
+    }
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
         return false;
+    library_path = names.get(record->library_path_id);
+    return true;
+}
 
-    std::map<std::string, PluginInfoPtr>::const_iterator plugin_info = classes_available.find(full_class_name);
-    if(plugin_info != classes_available.end())
+bool PluginManager::getAssociatedClassOfType(boost::string_view embedded_type, boost::string_view base_class_name, std::string& associated_class) const
+{
+    if(shared_registry || concurrent_readers)
     {
-        library_path = plugin_info->second->library_path;
+        std::vector<std::string> associated_classes = getAssociatedClassesOfType(embedded_type, base_class_name);
+        if(associated_classes.empty())
+            return false;
+        associated_class = associated_classes.front();
         return true;
     }
-    return false;
+
+    std::vector<uint32_t> associated_records;
+    if(!findAssociatedRecords(embedded_type, base_class_name, associated_records))
+        return false;
+
+    // the first class in sorted order is returned, usually there is only one
+    const std::string* first_class = NULL;
+    for(uint32_t record : associated_records)
+    {
+        const std::string& class_name = names.get(records[record].full_class_name_id);
+        if(first_class == NULL || class_name < *first_class)
+            first_class = &class_name;
+    }
+    associated_class = *first_class;
+    return true;
 }
 
-bool PluginManager::getAssociatedClassOfType(const std::string& embedded_type, const std::string& base_class_name, std::string& associated_class) const
+std::vector< std::string > PluginManager::getAssociatedClassesOfType(boost::string_view embedded_type, boost::string_view base_class_name) const
 {
-    std::vector<std::string> available_classes = getAvailableClasses(base_class_name);
-    for(const std::string& class_name : available_classes)
+    std::vector<std::string> classes;
+    if(shared_registry || concurrent_readers)
     {
-        std::vector<std::string> associated_classes;
-        if(getAssociatedClasses(class_name, associated_classes) && !associated_classes.empty())
+        std::string canonical_embedded_type, canonical_base_class_name;
+        embedded_type = TypeName::canonical(embedded_type, canonical_embedded_type);
+        base_class_name = TypeName::canonical(base_class_name, canonical_base_class_name);
+        if(concurrent_readers)
         {
-            std::vector<std::string>::const_iterator it = std::find(associated_classes.begin(), associated_classes.end(), embedded_type);
-            if(it != associated_classes.end())
-            {
-                associated_class = class_name;
-                return true;
-            }
+            boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+            if(snapshot)
+                snapshot->getAssociatedClassesOfType(embedded_type, base_class_name, classes);
+            return classes;
+        }
+        if(shared_registry->hasAvailableClassDetails())
+        {
+            shared_registry->getAssociatedClassesOfType(embedded_type, base_class_name, classes);
+            return classes;
+        }
+
+        // the registry was written without details, the classes of the base class are checked one by one
+        std::vector<std::string> available_classes = getAvailableClasses(base_class_name.to_string());
+        for(const std::string& class_name : available_classes)
+        {
+            std::vector<std::string> associated_classes;
+            if(getAssociatedClasses(class_name, associated_classes) &&
+               std::find(associated_classes.begin(), associated_classes.end(), embedded_type) != associated_classes.end())
+                classes.push_back(class_name);
         }
+        return classes;
     }
-    return false;
+
+    std::vector<uint32_t> associated_records;
+    if(!findAssociatedRecords(embedded_type, base_class_name, associated_records))
+        return classes;
+    classes.reserve(associated_records.size());
+    for(uint32_t record : associated_records)
+        classes.push_back(names.get(records[record].full_class_name_id));
+    std::sort(classes.begin(), classes.end());
+    return classes;
 }
 
 std::set< std::string > PluginManager::getRegisteredLibraries() const
 {
+    if(concurrent_readers)
+    {
+        std::set<std::string> registered_libraries;
+        boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+        if(snapshot)
+            snapshot->getRegisteredLibraries(registered_libraries);
+        return registered_libraries;
+    }
+
     std::set< std::string > registered_libraries;
-    for(const std::pair<std::string, PluginInfoPtr>& plugin_info : classes_available)
+    if(shared_registry)
+    {
+        std::vector<uint32_t> class_indexes;
+        shared_registry->getAvailableClassIndexes(class_indexes);
+        for(uint32_t class_index : class_indexes)
+            registered_libraries.insert(shared_registry->getClassField(class_index, RegistryCache::LIBRARY_PATH));
+        return registered_libraries;
+    }
+    // one step per library
+    for(ClassMultiIndex::const_iterator it = libraries_available.begin(); it != libraries_available.end();
+        it = libraries_available.upper_bound(it->first))
     {
-        registered_libraries.insert(plugin_info.second->library_path);
+        registered_libraries.insert(registered_libraries.end(), names.get(it->first));
     }
     return registered_libraries;
 }
 
 bool PluginManager::removeClassInfo(const std::string& class_name)
 {
-    std::string full_class_name;
-    if(!getFullClassName(class_name, full_class_name))
+    // the shared registry is read only, the process continues with its own copy
+    detachSharedRegistry();
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
         return false;
+    removeRecord(record - &records[0]);
+    publishChanges();
+    return true;
+}
+
+size_t PluginManager::removeLibrary(boost::string_view library_path)
+{
+    detachSharedRegistry();
+    size_t removed_classes = removeRecords(libraries_available, library_path);
+    publishChanges();
+    return removed_classes;
+}
+
+size_t PluginManager::removeClassesOfType(boost::string_view base_class_name)
+{
+    detachSharedRegistry();
+    size_t removed_classes = removeRecords(base_classes_available, base_class_name);
+    publishChanges();
+    return removed_classes;
+}
+
+void PluginManager::addMetaIndex(const std::string& key)
+{
+    if(!meta_index_keys.insert(key).second)
+        return;
 
-    std::map<std::string, PluginInfoPtr>::iterator plugin_info = classes_available.find(full_class_name);
-    if(plugin_info != classes_available.end())
+    // the classes whose details are already indexed are added now, the others once their details are loaded
+    for(uint32_t record = 0; record < records.size(); record++)
     {
-        std::pair<std::multimap<std::string, PluginInfoPtr>::iterator, std::multimap<std::string, PluginInfoPtr>::iterator> range;
-        range = base_classes_available.equal_range(plugin_info->second->base_class_name);
-        for(std::multimap<std::string, PluginInfoPtr>::iterator it = range.first; it != range.second; it++)
-        {
-            if(it->second == plugin_info->second)
-                base_classes_available.erase(it);
-        }
-        range = classes_no_ns_available.equal_range(plugin_info->second->class_name);
-        for(std::multimap<std::string, PluginInfoPtr>::iterator it = range.first; it != range.second; it++)
+        if(!records[record].plugin_info || !records[record].details_indexed)
+            continue;
+        for(const MetaAttribute& meta_attribute : records[record].plugin_info->meta_attributes)
         {
-            if(it->second == plugin_info->second)
-                classes_no_ns_available.erase(it);
+            if(meta_attribute.first == key)
+                indexMetaAttribute(record, meta_attribute);
         }
-        classes_available.erase(plugin_info);
-        return true;
     }
-    return false;
+    snapshot_outdated = true;
+    publishChanges();
 }
 
-void PluginManager::clear()
+std::vector< std::string > PluginManager::getClassesWithMeta(boost::string_view key, boost::string_view value,
+                                                             boost::string_view base_class_name) const
 {
-    classes_available.clear();
-    base_classes_available.clear();
-    classes_no_ns_available.clear();
+    std::vector<std::string> classes;
+    std::string canonical_base_class_name;
+    base_class_name = TypeName::canonical(base_class_name, canonical_base_class_name);
+    boost::shared_ptr<const RegistrySnapshot> snapshot = concurrent_readers ? getSnapshot() : boost::shared_ptr<const RegistrySnapshot>();
+    if(snapshot && snapshot->hasMetaIndex(key))
+    {
+        snapshot->getClassesWithMeta(key, value, base_class_name, classes);
+        return classes;
+    }
+    if(shared_registry && shared_registry->hasAvailableClassDetails())
+    {
+        shared_registry->getClassesWithMeta(key, value, base_class_name, classes);
+        return classes;
+    }
+    if(shared_registry || concurrent_readers || meta_index_keys.count(key.to_string()) == 0)
+    {
+        // without index the meta attributes of the classes are checked one by one
+        std::vector<std::string> available_classes = base_class_name.empty() ? getAvailableClasses() :
+                                                                               getAvailableClasses(base_class_name.to_string());
+        for(const std::string& class_name : available_classes)
+        {
+            const PluginInfo* plugin_info = getPluginInfo(resolve(class_name));
+            if(plugin_info == NULL)
+                continue;
+            for(const MetaAttribute& meta_attribute : plugin_info->meta_attributes)
+            {
+                if(meta_attribute.first == key && meta_attribute.second == value)
+                {
+                    classes.push_back(class_name);
+                    break;
+                }
+            }
+        }
+        return classes;
+    }
+
+    StringId base_class_name_id = invalid_string_id;
+    if(!base_class_name.empty() && !names.find(base_class_name, base_class_name_id))
+        return classes;
+
+    StringId key_id, value_id;
+    if(names.find(key, key_id) && names.find(value, value_id))
+    {
+        boost::unordered_map< uint64_t, std::vector<uint32_t> >::const_iterator meta_records = meta_available.find(indexKey(key_id, value_id));
+        if(meta_records != meta_available.end())
+        {
+            for(uint32_t record : meta_records->second)
+            {
+                if(base_class_name_id == invalid_string_id || records[record].base_class_name_id == base_class_name_id)
+                    classes.push_back(names.get(records[record].full_class_name_id));
+            }
+        }
+    }
+
+    // the classes whose details aren't indexed yet are compared one by one, see loadAllClassDetails
+    for(std::map<StringId, size_t>::const_iterator pending = pending_details.begin(); pending != pending_details.end(); pending++)
+    {
+        if(base_class_name_id != invalid_string_id && pending->first != base_class_name_id)
+            continue;
+        std::pair<ClassMultiIndex::const_iterator, ClassMultiIndex::const_iterator> range = base_classes_available.equal_range(pending->first);
+        for(ClassMultiIndex::const_iterator it = range.first; it != range.second; it++)
+        {
+            const ClassRecord& class_record = records[it->second];
+            if(class_record.details_indexed)
+                continue;
+            ensureClassDetails(class_record.plugin_info);
+            for(const MetaAttribute& meta_attribute : class_record.plugin_info->meta_attributes)
+            {
+                if(meta_attribute.first == key && meta_attribute.second == value)
+                {
+                    classes.push_back(names.get(class_record.full_class_name_id));
+                    break;
+                }
+            }
+        }
+    }
+    std::sort(classes.begin(), classes.end());
+    return classes;
 }
 
-void PluginManager::overridePluginXmlPaths(const std::vector< std::string >& plugin_xml_paths)
+std::vector< std::string > PluginManager::getClassesInNamespace(boost::string_view name_space, boost::string_view base_class_name) const
 {
-    this->plugin_xml_paths = plugin_xml_paths;
+    std::string prefix(name_space.data(), name_space.size());
+    if(!boost::ends_with(prefix, "::"))
+        prefix += "::";
+    return getClassesWithPrefix(prefix, base_class_name);
 }
 
-void PluginManager::reloadXMLPluginFiles()
+std::vector< std::string > PluginManager::getClassesWithPrefix(boost::string_view prefix, boost::string_view base_class_name) const
 {
-    std::set<std::string> plugin_xml_files;
-    for(const std::string &folder : plugin_xml_paths)
+    std::vector<std::string> classes;
+    std::string canonical_base_class_name;
+    base_class_name = TypeName::canonical(base_class_name, canonical_base_class_name);
+    if(concurrent_readers)
+    {
+        boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+        if(snapshot)
+            snapshot->getClassesWithPrefix(prefix, base_class_name, classes);
+        return classes;
+    }
+    if(shared_registry)
     {
-        determineAvailableXMLPluginFiles(folder, plugin_xml_files);
+        shared_registry->getClassesWithPrefix(prefix, base_class_name, classes);
+        return classes;
     }
-    for(const std::string &file : plugin_xml_files)
+
+    StringId base_class_name_id = invalid_string_id;
+    if(!base_class_name.empty() && !names.find(base_class_name, base_class_name_id))
+        return classes;
+    for(ClassNameIndex::const_iterator it = classes_by_name.lower_bound(prefix);
+        it != classes_by_name.end() && it->first.starts_with(prefix); it++)
     {
-        std::vector< PluginManager::PluginInfoPtr > classes;
-        if(processSingleXMLPluginFile(file, classes))
-            insertPluginInfos(classes);
+        if(base_class_name_id == invalid_string_id || records[it->second].base_class_name_id == base_class_name_id)
+            classes.push_back(it->first.to_string());
     }
+    return classes;
 }
 
-std::vector< std::string > PluginManager::getPluginXmlPathsFromEnv() const
+std::vector< std::string > PluginManager::getLibraryClasses(boost::string_view library_path) const
 {
-    const char* install_path = std::getenv("LD_LIBRARY_PATH");
-    std::vector<std::string> paths;
-    if(install_path != NULL)
+    std::vector<std::string> classes;
+    if(concurrent_readers)
+    {
+        boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+        if(snapshot)
+            snapshot->getLibraryClasses(library_path, classes);
+        return classes;
+    }
+    if(shared_registry)
     {
-        const std::string path(install_path);
-        //":" is the separator in LD_LIBRARY_PATH
-        boost::split(paths, path, boost::is_any_of(":"));
-        //trim ":" and " " from the beginning and end of the string
-        for(std::string& path : paths)
+        std::vector<uint32_t> class_indexes;
+        shared_registry->getAvailableClassIndexes(class_indexes);
+        for(uint32_t class_index : class_indexes)
         {
-            boost::trim_if(path, boost::is_any_of(": "));
-            boost::trim_right_if(path, boost::is_any_of("/"));
-            path += plugin_files_path;
+            if(shared_registry->getClassField(class_index, RegistryCache::LIBRARY_PATH) == library_path)
+                classes.push_back(shared_registry->getClassField(class_index, RegistryCache::FULL_CLASS_NAME));
         }
+        return classes;
     }
-    return paths;
+
+    StringId library_path_id;
+    if(!names.find(library_path, library_path_id))
+        return classes;
+    std::pair<ClassMultiIndex::const_iterator, ClassMultiIndex::const_iterator> range = libraries_available.equal_range(library_path_id);
+    for(ClassMultiIndex::const_iterator it = range.first; it != range.second; it++)
+        classes.push_back(names.get(records[it->second].full_class_name_id));
+    std::sort(classes.begin(), classes.end());
+    return classes;
 }
 
-void PluginManager::determineAvailableXMLPluginFiles(const std::string& plugin_xml_folder, std::set<std::string>& plugin_xml_files) const
+void PluginManager::clear()
 {
-    boost::filesystem::path folder(plugin_xml_folder);
-    if(boost::filesystem::exists(folder))
-    {
-        if(boost::filesystem::is_directory(folder))
-        {
-            for(boost::filesystem::directory_iterator it(folder); it != boost::filesystem::directory_iterator(); it++)
-            {
-                if(boost::filesystem::is_regular_file(*it))
-                {
-                    std::string extension = it->path().extension().string();
-                    boost::algorithm::to_lower(extension);
+    shared_registry.reset();
+    shared_plugin_infos.clear();
+    clearIndexes();
+    loaded_xml_files.clear();
+    live_name_count = 0;
+    publishChanges();
+}
 
-                    if(extension == plugin_file_extension)
-                        plugin_xml_files.insert(it->path().string());
-                }
-            }
-        }
-        else if(boost::filesystem::is_regular_file(folder))
-        {
-            // folder is actualy a file
-            std::string extension = folder.extension().string();
-            boost::algorithm::to_lower(extension);
+void PluginManager::clearIndexes()
+{
+    classes_available.clear();
+    classes_by_name.clear();
+    base_classes_available.clear();
+    classes_no_ns_available.clear();
+    libraries_available.clear();
+    associations_available.clear();
+    meta_available.clear();
+    pending_details.clear();
+    // the index nodes were given back to the arena, its blocks are freed at once
+    index_arena.release();
+    records.clear();
+    free_records.clear();
+    classes_shadowed.clear();
+    names.clear();
+    snapshot_outdated = true;
+    class_hierarchy_outdated = true;
+}
 
-            if(extension == plugin_file_extension)
-                plugin_xml_files.insert(folder.string());
-        }
+void PluginManager::compactNames()
+{
+    // names of removed or changed classes stay in the pool, it is rebuilt
+    // from the registered classes once it has doubled since the last time
+    if(names.size() <= 2 * live_name_count + 32)
+        return;
+
+    std::vector<PluginInfoPtr> available;
+    for(const ClassRecord& record : records)
+    {
+        if(record.plugin_info)
+            available.push_back(record.plugin_info);
+    }
+    std::vector<PluginInfoPtr> shadowed;
+    for(const std::pair<const StringId, PluginInfoPtr>& shadowed_class : classes_shadowed)
+        shadowed.push_back(shadowed_class.second);
+
+    clearIndexes();
+    for(const PluginInfoPtr& plugin_info : available)
+    {
+        internNames(*plugin_info);
+        indexPluginInfo(plugin_info);
+    }
+    for(const PluginInfoPtr& plugin_info : shadowed)
+    {
+        internNames(*plugin_info);
+        classes_shadowed.insert(std::make_pair(plugin_info->full_class_name_id, plugin_info));
     }
+    live_name_count = names.size();
 }
 
-bool PluginManager::processSingleXMLPluginFile(const std::string& xml_file, std::vector< PluginInfoPtr >& class_available)
+size_t PluginManager::getInternedNameCount() const
 {
-    TiXmlDocument document;
-    document.LoadFile(xml_file);
+    return names.size();
+}
+
+void PluginManager::overridePluginXmlPaths(const std::vector< std::string >& plugin_xml_paths)
+{
+    this->plugin_xml_paths = plugin_xml_paths;
+}
+
+void PluginManager::reloadXMLPluginFiles()
+{
+    reloadRegistry();
+    publishChanges();
+    pluginFilesReloaded();
+}
 
-    TiXmlElement* library = document.RootElement();
-    if (library == NULL)
+void PluginManager::reloadRegistry()
+{
+    // duplicated or linked folders and files are only taken once
+    DirectoryScanner scanner(plugin_file_extension);
+    std::map<std::string, FileFingerprint> bundled_files;
+    for(const std::string &folder : plugin_xml_paths)
     {
-        LOG(ERROR) << "Skipping XML Document " << xml_file << " which had no Root Element. This likely means the XML is malformed or missing.";
-        return false;
+        std::vector<std::string> folder_files;
+        scanner.scan(folder, &folder_files);
+        if(!folder_files.empty())
+            loadRegistryBundle(folder, folder_files, bundled_files);
     }
-    if (library->ValueStr() != "library")
+    const std::set<std::string>& plugin_xml_files = scanner.getFiles();
+
+    // files covered by a registry bundle are identified by their fingerprint in the bundle
+    std::map<std::string, FileFingerprint> fingerprints;
+    for(const std::string &xml_file : plugin_xml_files)
     {
-        LOG(ERROR) << "The XML document " << xml_file << " must have \"library\" as root tag.";
-        return false;
+        std::map<std::string, FileFingerprint>::const_iterator bundled_file = bundled_files.find(xml_file);
+        if(bundled_file != bundled_files.end())
+            fingerprints[xml_file] = bundled_file->second;
+        else
+            FileFingerprint::fromFile(xml_file, fingerprints[xml_file]);
     }
 
-    while (library != NULL)
+    // the shared registry is used as long as it was created from the same files
+    if(!shared_registry_name.empty() && !concurrent_readers)
     {
-        // read library path
-        const char* library_path = library->Attribute("path");
-        if (library_path == NULL)
+        if(shared_registry)
         {
-            LOG(ERROR) << "Failed to find path attirbute in library element in " << xml_file;
-            continue;
+            if(matchesSharedRegistry(*shared_registry, fingerprints))
+                return;
+            detachSharedRegistry();
         }
+        else if(loaded_xml_files.empty() && attachSharedRegistry(fingerprints))
+            return;
+    }
 
-        TiXmlElement* class_element = library->FirstChildElement("class");
-        while (class_element != NULL)
-        {
-            PluginInfoPtr plugin_info(new PluginInfo);
-            const char* base_class_name = class_element->Attribute("base_class_name");
-            const char* full_class_name = class_element->Attribute("class_name");
+    // determine the files that are new or have changed since the last reload
+    std::vector<XMLPluginFile> plugin_files;
+    std::vector<bool> processed_files;
+    std::map<std::string, boost::shared_ptr<RegistryCache> > bundles;
+    for(const std::pair<const std::string, FileFingerprint>& fingerprint : fingerprints)
+    {
+        std::map<std::string, XMLPluginFile>::const_iterator loaded_file = loaded_xml_files.find(fingerprint.first);
+        if(loaded_file != loaded_xml_files.end() && fingerprint.second.isValid() &&
+           loaded_file->second.fingerprint == fingerprint.second && !loaded_file->second.parse_failed)
+            continue;
 
-            if(base_class_name != NULL && full_class_name != NULL)
-            {
-                plugin_info->full_class_name = full_class_name;
-                plugin_info->base_class_name = base_class_name;
-                plugin_info->library_path = library_path;
-                plugin_info->class_name = removeNamespace(plugin_info->full_class_name);
-
-                // find description
-                TiXmlElement* description_element = class_element->FirstChildElement("description");
-                if(description_element != NULL)
-                    plugin_info->description = description_element->GetText();
-
-                // find associations
-                TiXmlElement* association_element = class_element->FirstChildElement("associations");
-                if(association_element != NULL)
-                {
-                    TiXmlElement* associated_class_element = association_element->FirstChildElement("class");
-                    while (associated_class_element != NULL)
-                    {
-                        const char* associated_class_name = associated_class_element->Attribute("class_name");
-                        if(associated_class_name != NULL)
-                            plugin_info->associated_classes.push_back(std::string(associated_class_name));
-                        associated_class_element = associated_class_element->NextSiblingElement("class");
-                    }
-                }
+        plugin_files.push_back(XMLPluginFile());
+        plugin_files.back().path = fingerprint.first;
+        plugin_files.back().fingerprint = fingerprint.second;
+        processed_files.push_back(bundled_files.count(fingerprint.first) != 0 && loadBundledFile(plugin_files.back(), bundles));
+    }
 
-                // find singleton information
-                plugin_info->singleton = false;
-                TiXmlElement* singleton_element = class_element->FirstChildElement("singleton");
-                if(singleton_element != NULL && strcmp(singleton_element->GetText(), "true") == 0)
-                {
-                    plugin_info->singleton = true;
-                }
+    // determine the files that have been deleted or are now found under a different path,
+    // files which are only no longer part of the plugin xml paths are kept
+    std::vector<std::string> removed_files;
+    for(const std::pair<const std::string, XMLPluginFile>& loaded_file : loaded_xml_files)
+    {
+        if(plugin_xml_files.count(loaded_file.first) == 0 &&
+           (!boost::filesystem::exists(loaded_file.first) || scanner.isKnownFile(loaded_file.first)))
+            removed_files.push_back(loaded_file.first);
+    }
 
-                // find meta information
-                TiXmlElement* meta_element = class_element->FirstChildElement("meta");
-                if(meta_element != NULL)
-                {
-                    // parse user specific tags using a callback function
-                    this->parsePluginMetaInformation(plugin_info, meta_element);
-                }
+    if(plugin_files.empty() && removed_files.empty())
+        return;
 
-                class_available.push_back(plugin_info);
-            }
-            else
+    // take the plugin infos of unchanged files from the registry cache
+    std::vector<bool> cached(processed_files);
+    size_t cached_file_count = 0;
+    if(!registry_cache_file.empty())
+    {
+        RegistryCache cache;
+        if(cache.open(registry_cache_file))
+        {
+            cached_file_count = cache.getFileCount();
+            for(size_t i = 0; i < plugin_files.size(); i++)
             {
-                LOG(ERROR) << "Couldn't find a valid class_name or base_class_name attribute in class element in " << xml_file;
+                if(!processed_files[i] && plugin_files[i].fingerprint.isValid() && cache.lookup(plugin_files[i].fingerprint, plugin_files[i]) &&
+                   (lazy_loading || hasAllClassDetails(plugin_files[i])))
+                {
+                    processed_files[i] = true;
+                    cached[i] = true;
+                    restoreMetaInformation(plugin_files[i]);
+                }
             }
-            class_element = class_element->NextSiblingElement("class");
         }
-        library = library->NextSiblingElement("library");
     }
 
-    return true;
-}
+    // parse all remaining files first, the merge below keeps the sorted file order
+    processXMLPluginFiles(plugin_files, processed_files);
 
-void PluginManager::insertPluginInfos(const std::vector<PluginInfoPtr>& classes)
-{
-    for(const PluginInfoPtr &plugin_info : classes)
+    bool cache_outdated = !removed_files.empty();
+    for(const std::string& xml_file : removed_files)
+        removeXMLPluginFile(xml_file);
+    for(size_t i = 0; i < plugin_files.size(); i++)
     {
-        if(classes_available.count(plugin_info->full_class_name) == 0)
+        removeXMLPluginFile(plugin_files[i].path);
+        if(processed_files[i])
         {
-            classes_available[plugin_info->full_class_name] = plugin_info;
-            base_classes_available.insert(std::make_pair(plugin_info->base_class_name, plugin_info));
-            classes_no_ns_available.insert(std::make_pair(plugin_info->class_name, plugin_info));
+            cache_outdated |= !cached[i];
+            insertXMLPluginFile(plugin_files[i]);
         }
         else
         {
-            LOG(WARNING) << "Class " << plugin_info->full_class_name << " already available, cannot add class info twice.";
+            // files which failed to parse are tracked without classes,
+            // so they are processed again on the next reload
+            plugin_files[i].classes.clear();
+            plugin_files[i].meta_elements.clear();
+            plugin_files[i].base_classes.clear();
+            plugin_files[i].parse_failed = true;
+            insertXMLPluginFile(plugin_files[i]);
         }
     }
+
+    compactNames();
+
+    std::vector<const XMLPluginFile*> valid_files;
+    for(const std::pair<const std::string, XMLPluginFile>& loaded_file : loaded_xml_files)
+    {
+        if(loaded_file.second.fingerprint.isValid())
+            valid_files.push_back(&loaded_file.second);
+    }
+    if(!registry_cache_file.empty() && (cache_outdated || valid_files.size() != cached_file_count))
+        RegistryCache::write(registry_cache_file, valid_files);
+
+    // later processes attach to the new registry
+    if(!shared_registry_name.empty())
+        RegistryCache::writeSharedMemory(getSharedRegistrySegment(), valid_files);
 }
 
-bool PluginManager::hasNamespace(const std::string& class_name) const
+void PluginManager::setReloadWorkerThreads(unsigned int worker_threads)
 {
-    if(hasEmbeddedType(class_name))
-        return extractBaseType(class_name).find("::") != std::string::npos;
-    else
-        return class_name.find("::") != std::string::npos;
+    reload_worker_threads = worker_threads;
 }
 
-bool PluginManager::hasEmbeddedType(const std::string& class_name) const
+unsigned int PluginManager::getReloadWorkerThreads() const
 {
-    return class_name.find("<") != std::string::npos;
+    return reload_worker_threads;
 }
 
-std::string PluginManager::extractEmbeddedType(const std::string& class_name) const
+void PluginManager::setLazyLoading(bool lazy_loading)
 {
-    return std::string(boost::end(boost::find_first(class_name, "<")), boost::begin(boost::find_last(class_name, ">")));
+    this->lazy_loading = lazy_loading;
 }
 
-std::string PluginManager::extractBaseType(const std::string& class_name) const
+bool PluginManager::getLazyLoading() const
 {
-    return std::string(class_name.begin(), boost::begin(boost::find_first(class_name, "<")));
+    return lazy_loading;
 }
 
-std::string PluginManager::removeNamespace(const std::string& class_name) const
+void PluginManager::setRegistryCacheFile(const std::string& registry_cache_file)
 {
-    // remove embedded type if necessary
-    bool has_embedded_type = hasEmbeddedType(class_name);
-    std::string class_name_base;
-    if (has_embedded_type)
-        class_name_base = extractBaseType(class_name);
-    else
-        class_name_base = class_name;
-
-    // remove namespace
-    std::string class_name_no_ns;
-    std::vector<std::string> split_names;
-    boost::split(split_names, class_name_base, boost::is_any_of("::"));
-    if(!split_names.empty())
-        class_name_no_ns = split_names.back();
-    else
-        class_name_no_ns = class_name;
-
-    if (has_embedded_type)
-        return class_name_no_ns + "<" + extractEmbeddedType(class_name) + ">";
-    else
-        return class_name_no_ns;
+    this->registry_cache_file = registry_cache_file;
 }
 
-void PluginManager::parsePluginMetaInformation(const PluginInfoPtr& plugin_info, TiXmlElement* meta_element)
+const std::string& PluginManager::getRegistryCacheFile() const
 {
-    // Can be implemented in inherited classes
+    return registry_cache_file;
 }
 
-bool PluginManager::getFullClassName(const std::string& class_name, std::string& full_class_name) const
+void PluginManager::setConcurrentReaders(bool concurrent_readers)
 {
-    if(classes_available.count(class_name) >= 1)
+    this->concurrent_readers = concurrent_readers;
+    if(concurrent_readers)
     {
-        // even if class_name doesn't have a namespace, this is all information we have
-        full_class_name = class_name;
-        return true;
+        // the snapshot is taken from the process local registry
+        detachSharedRegistry();
+        snapshot_outdated = true;
+        publishSnapshot();
     }
     else
-    {
-        size_t count = classes_no_ns_available.count(class_name);
-        if(count == 1)
-        {
-            full_class_name = classes_no_ns_available.find(class_name)->second->full_class_name;
-            return true;
-        }
-        else if(count == 0)
-            LOG(WARNING) << "Class " << class_name << " is unknown.";
+        boost::atomic_store(&snapshot, boost::shared_ptr<const RegistrySnapshot>());
+}
+
+bool PluginManager::getConcurrentReaders() const
+{
+    return concurrent_readers;
+}
+
+void PluginManager::setSharedRegistry(const std::string& shared_registry_name)
+{
+    this->shared_registry_name = shared_registry_name;
+}
+
+const std::string& PluginManager::getSharedRegistry() const
+{
+    return shared_registry_name;
+}
+
+bool PluginManager::isSharedRegistryAttached() const
+{
+    return shared_registry.get() != NULL;
+}
+
+void PluginManager::removeSharedRegistry() const
+{
+    if(!shared_registry_name.empty())
+        shm_unlink(getSharedRegistrySegment().c_str());
+}
+
+bool PluginManager::writeRegistryBundle(const std::string& plugin_xml_folder)
+{
+    DirectoryScanner scanner(plugin_file_extension);
+    std::vector<std::string> xml_files;
+    scanner.scan(plugin_xml_folder, &xml_files);
+    if(!boost::filesystem::is_directory(plugin_xml_folder))
+    {
+        LOG(ERROR) << "Cannot create a registry bundle, " << plugin_xml_folder << " is not a folder.";
+        return false;
+    }
+
+    // the bundle always contains the details of all classes, files which failed to
+    // parse are kept without classes, so the bundle still matches the folder content
+    std::vector<XMLPluginFile> plugin_files(xml_files.size());
+    std::vector<const XMLPluginFile*> bundled_files;
+    for(size_t i = 0; i < xml_files.size(); i++)
+    {
+        plugin_files[i].path = xml_files[i];
+        if(!FileFingerprint::fromFile(xml_files[i], plugin_files[i].fingerprint))
+            return false;
+        processSingleXMLPluginFile(plugin_files[i], true, true);
+
+        // the files are stored relative to the folder, so it can be relocated
+        plugin_files[i].path = boost::filesystem::path(xml_files[i]).filename().string();
+        bundled_files.push_back(&plugin_files[i]);
+    }
+
+    std::string bundle_file = (boost::filesystem::path(plugin_xml_folder) / registry_bundle_name).string();
+    return RegistryCache::write(bundle_file, bundled_files);
+}
+
+std::vector< std::string > PluginManager::getPluginXmlPathsFromEnv() const
+{
+    std::vector<std::string> paths = DirectoryScanner::getLibraryPathsFromEnv();
+    for(std::string& path : paths)
+        path += plugin_files_path;
+    return paths;
+}
+
+bool PluginManager::processSingleXMLPluginFile(XMLPluginFile& plugin_file, bool parse_details, bool keep_meta_elements)
+{
+    PluginXmlParser parser;
+    std::vector<std::string> meta_elements;
+    if(!parser.load(plugin_file.path) || !parser.parse(parse_details, plugin_file.classes, meta_elements, plugin_file.base_classes))
+    {
+        LOG(ERROR) << "Skipping XML Document: " << parser.getError();
+        plugin_file.classes.clear();
+        plugin_file.base_classes.clear();
+        return false;
+    }
+
+    for(size_t i = 0; i < plugin_file.classes.size(); i++)
+    {
+        const PluginInfoPtr& plugin_info = plugin_file.classes[i];
+        plugin_info->class_name = removeNamespace(plugin_info->full_class_name);
+        if(parse_details)
+            processMetaInformation(plugin_info, meta_elements[i]);
+    }
+
+    // keep the meta elements for the registry cache
+    if(parse_details && keep_meta_elements)
+        plugin_file.meta_elements.swap(meta_elements);
+
+    return true;
+}
+
+bool PluginManager::loadClassDetails(boost::string_view class_name) const
+{
+    // the details are loaded before a snapshot is published
+    if(concurrent_readers)
+        return resolve(class_name).isValid();
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
+        return false;
+    return ensureClassDetails(record->plugin_info);
+}
+
+bool PluginManager::ensureClassDetails(const PluginInfoPtr& plugin_info) const
+{
+    // readers of a snapshot only see plugin infos whose details were loaded before it was published
+    std::unique_lock<std::recursive_mutex> lock(details_mutex, std::defer_lock);
+    if(!concurrent_readers)
+        lock.lock();
+    if(plugin_info->details_loaded)
+        return true;
+
+    // loading is only tried once, errors would repeat on each query otherwise
+    plugin_info->details_loaded = true;
+
+    PluginXmlParser parser;
+    std::string meta_element;
+    if(!parser.load(plugin_info->xml_file) || !parser.parseClassDetails(*plugin_info, meta_element))
+    {
+        LOG(ERROR) << "Failed to load the details of class " << plugin_info->full_class_name << ": " << parser.getError();
+        return false;
+    }
+
+    // the meta information callback is part of the lazily loaded state
+    const_cast<PluginManager*>(this)->processMetaInformation(plugin_info, meta_element);
+    return true;
+}
+
+void PluginManager::processMetaInformation(const PluginInfoPtr& plugin_info, const std::string& meta_element)
+{
+    // the meta attributes are parsed with the class, a document is only needed by an inherited callback
+    if(meta_element.empty() || !overridesMetaInformationCallback())
+        return;
+    TiXmlDocument document;
+    document.Parse(meta_element.c_str());
+    TiXmlElement* element = document.RootElement();
+    if(element != NULL)
+        this->parsePluginMetaInformation(plugin_info, element);
+    else
+        LOG(ERROR) << "Failed to parse the meta information of class " << plugin_info->full_class_name;
+}
+
+void PluginManager::restoreMetaAttributes(const PluginInfoPtr& plugin_info, const std::string& meta_element)
+{
+    plugin_info->meta_attributes.clear();
+    PluginXmlParser parser;
+    if(!parser.parseMetaElement(meta_element, plugin_info->meta_attributes))
+        LOG(ERROR) << "Failed to parse the meta information of class " << plugin_info->full_class_name << ": " << parser.getError();
+}
+
+bool PluginManager::overridesMetaInformationCallback() const
+{
+#if defined(__GNUC__) && !defined(__clang__)
+    // GCC resolves the callback of the dynamic type, it is compared to the one of this class
+    PluginManager* self = const_cast<PluginManager*>(this);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpmf-conversions"
+    return (MetaInformationCallback)(self->*(&PluginManager::parsePluginMetaInformation)) != default_meta_callback;
+#pragma GCC diagnostic pop
+#else
+    // without a way to compare the callbacks the document is always built
+    return true;
+#endif
+}
+
+void PluginManager::processXMLPluginFiles(std::vector<XMLPluginFile>& plugin_files, std::vector<bool>& processed_files)
+{
+    std::vector<size_t> pending_files;
+    for(size_t i = 0; i < plugin_files.size(); i++)
+    {
+        if(!processed_files[i])
+            pending_files.push_back(i);
+    }
+
+    const bool parse_details = !lazy_loading || concurrent_readers;
+    const bool keep_meta_elements = !registry_cache_file.empty() || !shared_registry_name.empty();
+    size_t workers = reload_worker_threads;
+    if(workers == 0)
+        workers = std::max(std::thread::hardware_concurrency(), 1u);
+    workers = std::min(workers, pending_files.size());
+
+    if(workers <= 1)
+    {
+        for(size_t i : pending_files)
+            processed_files[i] = processSingleXMLPluginFile(plugin_files[i], parse_details, keep_meta_elements);
+        return;
+    }
+
+    // every worker writes only to the slots of the files it picked,
+    // std::vector<bool> is packed and therefore collected separately
+    std::vector<char> processed(pending_files.size(), 0);
+    std::atomic<size_t> next_file(0);
+    auto worker = [&]()
+    {
+        for(size_t i = next_file++; i < pending_files.size(); i = next_file++)
+            processed[i] = processSingleXMLPluginFile(plugin_files[pending_files[i]], parse_details, keep_meta_elements) ? 1 : 0;
+    };
+
+    // the calling thread is one of the workers
+    std::vector< std::future<void> > results;
+    for(size_t i = 1; i < workers; i++)
+        results.push_back(std::async(std::launch::async, worker));
+    worker();
+    for(std::future<void>& result : results)
+        result.get();
+
+    for(size_t i = 0; i < pending_files.size(); i++)
+        processed_files[pending_files[i]] = processed[i] != 0;
+}
+
+void PluginManager::loadRegistryBundle(const std::string& plugin_xml_folder, const std::vector<std::string>& xml_files,
+                                       std::map<std::string, FileFingerprint>& bundled_files) const
+{
+    RegistryCache bundle;
+    if(!bundle.open((boost::filesystem::path(plugin_xml_folder) / registry_bundle_name).string()))
+        return;
+
+    // the bundle is only used if it covers exactly the xml files of the folder
+    if(bundle.getFileCount() != xml_files.size())
+        return;
+    const std::set<std::string> folder_files(xml_files.begin(), xml_files.end());
+    const std::string folder_path = boost::trim_right_copy_if(plugin_xml_folder, boost::is_any_of("/")) + "/";
+    std::vector<XMLPluginFile> plugin_files(xml_files.size());
+    for(size_t i = 0; i < plugin_files.size(); i++)
+    {
+        if(!bundle.getFileInfo(i, plugin_files[i]))
+            return;
+        plugin_files[i].path = folder_path + plugin_files[i].path;
+        if(folder_files.count(plugin_files[i].path) == 0)
+            return;
+    }
+
+    // files changed after the bundle was written are parsed, they are identified
+    // by the same fingerprint the registry cache uses
+    for(const XMLPluginFile& plugin_file : plugin_files)
+    {
+        FileFingerprint fingerprint;
+        if(FileFingerprint::fromFile(plugin_file.path, fingerprint) && fingerprint == plugin_file.fingerprint)
+            bundled_files[plugin_file.path] = plugin_file.fingerprint;
         else
-            LOG(WARNING) << "Class " << class_name << " is multiple defined in different namespaces. Please use the full class name.";
+            LOG(WARNING) << "The registry bundle of " << plugin_xml_folder << " is outdated for " << plugin_file.path
+                         << ", the file is parsed. Write the bundle again to update it.";
     }
+}
+
+bool PluginManager::loadBundledFile(XMLPluginFile& plugin_file, std::map<std::string, boost::shared_ptr<RegistryCache> >& bundles)
+{
+    // each bundle is only mapped once per reload
+    boost::filesystem::path xml_file(plugin_file.path);
+    boost::shared_ptr<RegistryCache>& bundle = bundles[xml_file.parent_path().string()];
+    if(!bundle)
+    {
+        bundle.reset(new RegistryCache);
+        bundle->open((xml_file.parent_path() / registry_bundle_name).string());
+    }
+
+    // the bundle stores the file names relative to the folder
+    XMLPluginFile bundled_file;
+    bundled_file.path = xml_file.filename().string();
+    if(!bundle->lookup(plugin_file.fingerprint, bundled_file))
+        return false;
+    plugin_file.classes.swap(bundled_file.classes);
+    plugin_file.meta_elements.swap(bundled_file.meta_elements);
+    for(const PluginInfoPtr& plugin_info : plugin_file.classes)
+        plugin_info->xml_file = plugin_file.path;
+    restoreMetaInformation(plugin_file);
+    return true;
+}
+
+std::string PluginManager::getSharedRegistrySegment() const
+{
+    // processes with different plugin xml paths use different segments
+    uint64_t hash = 14695981039346656037ULL;
+    for(const std::string& path : plugin_xml_paths)
+    {
+        for(const char c : path + ":")
+        {
+            hash ^= (unsigned char)c;
+            hash *= 1099511628211ULL;
+        }
+    }
+    std::stringstream segment;
+    // segments are per user, a segment of another user is never used
+    segment << "/" << boost::trim_left_copy_if(shared_registry_name, boost::is_any_of("/")) << "_" << geteuid() << "_" << std::hex << hash;
+    return segment.str();
+}
+
+bool PluginManager::matchesSharedRegistry(const RegistryCache& registry, const std::map<std::string, FileFingerprint>& fingerprints)
+{
+    if(registry.getFileCount() != fingerprints.size())
+        return false;
+
+    // both are sorted by path
+    std::map<std::string, FileFingerprint>::const_iterator fingerprint = fingerprints.begin();
+    for(size_t i = 0; i < registry.getFileCount(); i++, fingerprint++)
+    {
+        XMLPluginFile plugin_file;
+        if(!registry.getFileInfo(i, plugin_file) || plugin_file.path != fingerprint->first ||
+           !plugin_file.fingerprint.isValid() || plugin_file.fingerprint != fingerprint->second)
+            return false;
+    }
+    return true;
+}
+
+bool PluginManager::attachSharedRegistry(const std::map<std::string, FileFingerprint>& fingerprints)
+{
+    boost::shared_ptr<RegistryCache> registry(new RegistryCache);
+    if(!registry->openSharedMemory(getSharedRegistrySegment()) || !matchesSharedRegistry(*registry, fingerprints))
+        return false;
+    shared_registry = registry;
+    class_hierarchy_outdated = true;
+
+    // the meta information callback is called for the classes like after parsing them
+    if(!lazy_loading)
+    {
+        for(uint32_t class_index = 0; class_index < shared_registry->getClassCount(); class_index++)
+        {
+            if(!shared_registry->hasClassDetails(class_index))
+                continue;
+            std::string meta_element = shared_registry->getClassField(class_index, RegistryCache::META_ELEMENT);
+            if(meta_element.empty())
+                continue;
+            PluginInfoPtr plugin_info = getSharedPluginInfo(class_index);
+            restoreMetaAttributes(plugin_info, meta_element);
+            processMetaInformation(plugin_info, meta_element);
+        }
+    }
+    return true;
+}
+
+void PluginManager::detachSharedRegistry()
+{
+    if(!shared_registry)
+        return;
+
+    // the registry is copied into the process, plugin infos which were already created are kept
+    uint32_t class_index = 0;
+    for(size_t i = 0; i < shared_registry->getFileCount(); i++)
+    {
+        XMLPluginFile plugin_file;
+        if(!shared_registry->getFile(i, plugin_file))
+            break;
+        for(size_t j = 0; j < plugin_file.classes.size(); j++, class_index++)
+        {
+            std::map<uint32_t, PluginInfoPtr>::const_iterator shared_plugin_info = shared_plugin_infos.find(class_index);
+            if(shared_plugin_info != shared_plugin_infos.end())
+                plugin_file.classes[j] = shared_plugin_info->second;
+            else if(lazy_loading && !plugin_file.meta_elements[j].empty())
+                plugin_file.classes[j]->details_loaded = false;
+        }
+        insertXMLPluginFile(plugin_file);
+    }
+    shared_registry.reset();
+    shared_plugin_infos.clear();
+    class_hierarchy_outdated = true;
+}
+
+bool PluginManager::findSharedClass(boost::string_view class_name, uint32_t& class_index) const
+{
+    std::string canonical_name;
+    class_name = TypeName::canonical(class_name, canonical_name);
+    if(shared_registry->findClass(class_name, class_index))
+        return true;
+
+    size_t count = shared_registry->findClassesWithoutNamespace(class_name, class_index);
+    if(count == 1)
+        return true;
+    else if(count == 0)
+        LOG(WARNING) << "Class " << class_name << " is unknown.";
+    else
+        LOG(WARNING) << "Class " << class_name << " is multiple defined in different namespaces. Please use the full class name.";
     return false;
+}
+
+bool PluginManager::hasSharedClassDetails(uint32_t class_index) const
+{
+    // plugin infos which were created for a class take precedence
+    std::lock_guard<std::recursive_mutex> lock(details_mutex);
+    if(shared_plugin_infos.count(class_index) != 0 || !shared_registry->hasClassDetails(class_index))
+        return false;
+    return !lazy_loading || shared_registry->getClassField(class_index, RegistryCache::META_ELEMENT).empty();
+}
+
+PluginManager::PluginInfoPtr PluginManager::getSharedPluginInfo(uint32_t class_index) const
+{
+    // const queries of several threads may create plugin infos at once
+    std::lock_guard<std::recursive_mutex> lock(details_mutex);
+    std::map<uint32_t, PluginInfoPtr>::const_iterator shared_plugin_info = shared_plugin_infos.find(class_index);
+    if(shared_plugin_info != shared_plugin_infos.end())
+        return shared_plugin_info->second;
+
+    PluginInfoPtr plugin_info(new PluginInfo);
+    shared_registry->readClass(class_index, *plugin_info);
+    // in lazy mode the meta information callback is called when the details are loaded
+    if(lazy_loading && !shared_registry->getClassField(class_index, RegistryCache::META_ELEMENT).empty())
+        plugin_info->details_loaded = false;
+    shared_plugin_infos[class_index] = plugin_info;
+    return plugin_info;
+}
+
+bool PluginManager::hasAllClassDetails(const XMLPluginFile& plugin_file)
+{
+    for(const PluginInfoPtr& plugin_info : plugin_file.classes)
+    {
+        if(!plugin_info->details_loaded)
+            return false;
+    }
+    return true;
+}
+
+void PluginManager::restoreMetaInformation(const XMLPluginFile& plugin_file)
+{
+    for(size_t i = 0; i < plugin_file.classes.size() && i < plugin_file.meta_elements.size(); i++)
+    {
+        if(plugin_file.meta_elements[i].empty())
+            continue;
+
+        // in lazy mode the meta information is parsed on demand from the xml file
+        if(lazy_loading)
+        {
+            plugin_file.classes[i]->details_loaded = false;
+            continue;
+        }
+
+        restoreMetaAttributes(plugin_file.classes[i], plugin_file.meta_elements[i]);
+        processMetaInformation(plugin_file.classes[i], plugin_file.meta_elements[i]);
+    }
+}
+
+void PluginManager::insertPluginInfos(const std::vector<PluginInfoPtr>& classes)
+{
+    for(const PluginInfoPtr &plugin_info : classes)
+    {
+        internNames(*plugin_info);
+        ClassIndex::iterator existing = classes_available.find(plugin_info->full_class_name_id);
+        if(existing == classes_available.end())
+        {
+            indexPluginInfo(plugin_info);
+            continue;
+        }
+
+        const PluginInfoPtr& existing_plugin_info = records[existing->second].plugin_info;
+        if(!plugin_info->xml_file.empty() && !existing_plugin_info->xml_file.empty() &&
+           plugin_info->xml_file < existing_plugin_info->xml_file)
+        {
+            // a file that comes first in sorted order was added or changed, it takes over the class
+            classes_shadowed.insert(std::make_pair(existing_plugin_info->full_class_name_id, existing_plugin_info));
+            unindexRecord(existing->second);
+            indexPluginInfo(plugin_info);
+        }
+        else
+        {
+            LOG(WARNING) << "Class " << plugin_info->full_class_name << " already available, cannot add class info twice.";
+            classes_shadowed.insert(std::make_pair(plugin_info->full_class_name_id, plugin_info));
+        }
+    }
+}
+
+void PluginManager::internNames(PluginInfo& plugin_info)
+{
+    plugin_info.class_name_id = names.intern(plugin_info.class_name);
+    plugin_info.full_class_name_id = names.intern(plugin_info.full_class_name);
+    plugin_info.base_class_name_id = names.intern(plugin_info.base_class_name);
+    plugin_info.library_path_id = names.intern(plugin_info.library_path);
+}
+
+void PluginManager::indexPluginInfo(const PluginInfoPtr& plugin_info)
+{
+    uint32_t record;
+    if(free_records.empty())
+    {
+        record = records.size();
+        records.push_back(ClassRecord());
+    }
+    else
+    {
+        record = free_records.back();
+        free_records.pop_back();
+    }
+
+    ClassRecord& class_record = records[record];
+    class_record.full_class_name_id = plugin_info->full_class_name_id;
+    class_record.class_name_id = plugin_info->class_name_id;
+    class_record.base_class_name_id = plugin_info->base_class_name_id;
+    class_record.library_path_id = plugin_info->library_path_id;
+    class_record.details_indexed = false;
+    class_record.plugin_info = plugin_info;
+
+    classes_available[class_record.full_class_name_id] = record;
+    classes_by_name[names.get(class_record.full_class_name_id)] = record;
+    class_record.base_class_entry = base_classes_available.insert(std::make_pair(class_record.base_class_name_id, record));
+    class_record.class_name_entry = classes_no_ns_available.insert(std::make_pair(class_record.class_name_id, record));
+    class_record.library_entry = libraries_available.insert(std::make_pair(class_record.library_path_id, record));
+    snapshot_outdated = true;
+    class_hierarchy_outdated = true;
+
+    // the associations of lazily loaded classes are indexed once their details are needed
+    if(plugin_info->details_loaded)
+        indexClassDetails(record);
+    else
+        pending_details[class_record.base_class_name_id]++;
+}
+
+void PluginManager::indexClassDetails(uint32_t record)
+{
+    ClassRecord& class_record = records[record];
+    for(const std::string& associated_class : class_record.plugin_info->associated_classes)
+    {
+        std::vector<uint32_t>& associated_records = associations_available[indexKey(names.intern(associated_class), class_record.base_class_name_id)];
+        if(associated_records.empty() || associated_records.back() != record)
+            associated_records.push_back(record);
+    }
+    if(!meta_index_keys.empty())
+    {
+        for(const MetaAttribute& meta_attribute : class_record.plugin_info->meta_attributes)
+            indexMetaAttribute(record, meta_attribute);
+    }
+    class_record.details_indexed = true;
+}
+
+void PluginManager::indexMetaAttribute(uint32_t record, const MetaAttribute& meta_attribute)
+{
+    if(meta_index_keys.count(meta_attribute.first) == 0)
+        return;
+    std::vector<uint32_t>& meta_records = meta_available[indexKey(names.intern(meta_attribute.first), names.intern(meta_attribute.second))];
+    if(meta_records.empty() || meta_records.back() != record)
+        meta_records.push_back(record);
+}
+
+void PluginManager::loadAllClassDetails()
+{
+    while(!pending_details.empty())
+        loadPendingDetails(pending_details.begin()->first);
+}
+
+void PluginManager::loadPendingDetails(StringId base_class_name_id)
+{
+    std::map<StringId, size_t>::iterator pending = pending_details.find(base_class_name_id);
+    if(pending == pending_details.end())
+        return;
+
+    std::pair<ClassMultiIndex::const_iterator, ClassMultiIndex::const_iterator> range = base_classes_available.equal_range(base_class_name_id);
+    for(ClassMultiIndex::const_iterator it = range.first; it != range.second; it++)
+    {
+        if(records[it->second].details_indexed)
+            continue;
+        ensureClassDetails(records[it->second].plugin_info);
+        indexClassDetails(it->second);
+    }
+    pending_details.erase(pending);
+}
+
+bool PluginManager::findAssociatedRecords(boost::string_view embedded_type, boost::string_view base_class_name,
+                                          std::vector<uint32_t>& associated_records) const
+{
+    std::string canonical_base_class_name;
+    StringId base_class_name_id;
+    if(!names.find(TypeName::canonical(base_class_name, canonical_base_class_name), base_class_name_id))
+        return false;
+
+    std::string canonical_embedded_type;
+    embedded_type = TypeName::canonical(embedded_type, canonical_embedded_type);
+    StringId embedded_type_id;
+    if(names.find(embedded_type, embedded_type_id))
+    {
+        boost::unordered_map< uint64_t, std::vector<uint32_t> >::const_iterator indexed_records =
+            associations_available.find(indexKey(embedded_type_id, base_class_name_id));
+        if(indexed_records != associations_available.end())
+            associated_records = indexed_records->second;
+    }
+
+    // the classes whose details aren't indexed yet are checked one by one, see loadAllClassDetails
+    if(pending_details.count(base_class_name_id) != 0)
+    {
+        std::pair<ClassMultiIndex::const_iterator, ClassMultiIndex::const_iterator> range = base_classes_available.equal_range(base_class_name_id);
+        for(ClassMultiIndex::const_iterator it = range.first; it != range.second; it++)
+        {
+            const ClassRecord& class_record = records[it->second];
+            if(class_record.details_indexed)
+                continue;
+            ensureClassDetails(class_record.plugin_info);
+            const std::vector<std::string>& associated_classes = class_record.plugin_info->associated_classes;
+            if(std::find(associated_classes.begin(), associated_classes.end(), embedded_type) != associated_classes.end())
+                associated_records.push_back(it->second);
+        }
+    }
+    return !associated_records.empty();
+}
+
+uint64_t PluginManager::indexKey(StringId first_id, StringId second_id)
+{
+    return ((uint64_t)first_id << 32) | second_id;
+}
+
+void PluginManager::unindexRecord(uint32_t record)
+{
+    ClassRecord& class_record = records[record];
+    if(class_record.details_indexed)
+    {
+        for(const std::string& associated_class : class_record.plugin_info->associated_classes)
+        {
+            StringId embedded_type_id;
+            if(names.find(associated_class, embedded_type_id))
+                eraseFromIndex(associations_available, indexKey(embedded_type_id, class_record.base_class_name_id), record);
+        }
+        for(const MetaAttribute& meta_attribute : class_record.plugin_info->meta_attributes)
+        {
+            StringId key_id, value_id;
+            if(meta_index_keys.count(meta_attribute.first) != 0 && names.find(meta_attribute.first, key_id) &&
+               names.find(meta_attribute.second, value_id))
+                eraseFromIndex(meta_available, indexKey(key_id, value_id), record);
+        }
+    }
+    else
+    {
+        std::map<StringId, size_t>::iterator pending = pending_details.find(class_record.base_class_name_id);
+        if(pending != pending_details.end() && --pending->second == 0)
+            pending_details.erase(pending);
+    }
+    base_classes_available.erase(class_record.base_class_entry);
+    classes_no_ns_available.erase(class_record.class_name_entry);
+    libraries_available.erase(class_record.library_entry);
+    classes_available.erase(class_record.full_class_name_id);
+    classes_by_name.erase(names.get(class_record.full_class_name_id));
+    class_record.plugin_info.reset();
+    free_records.push_back(record);
+    snapshot_outdated = true;
+    class_hierarchy_outdated = true;
+}
+
+void PluginManager::removeRecord(uint32_t record)
+{
+    // the file has to be processed again on the next reload to restore the class
+    std::map<std::string, XMLPluginFile>::iterator xml_file = loaded_xml_files.find(records[record].plugin_info->xml_file);
+    if(xml_file != loaded_xml_files.end())
+        xml_file->second.fingerprint = FileFingerprint();
+
+    unindexRecord(record);
+}
+
+size_t PluginManager::removeRecords(const ClassMultiIndex& index, boost::string_view key)
+{
+    StringId key_id;
+    if(!names.find(key, key_id))
+        return 0;
+
+    // the records are collected first, removing them erases the index entries
+    std::vector<uint32_t> removed_records;
+    std::pair<ClassMultiIndex::const_iterator, ClassMultiIndex::const_iterator> range = index.equal_range(key_id);
+    for(ClassMultiIndex::const_iterator it = range.first; it != range.second; it++)
+        removed_records.push_back(it->second);
+    for(uint32_t record : removed_records)
+        removeRecord(record);
+    return removed_records.size();
+}
+
+void PluginManager::insertXMLPluginFile(const XMLPluginFile& plugin_file)
+{
+    loaded_xml_files[plugin_file.path] = plugin_file;
+    insertPluginInfos(plugin_file.classes);
+    // the file may only declare base classes
+    snapshot_outdated = true;
+    class_hierarchy_outdated = true;
+}
+
+void PluginManager::removeXMLPluginFile(const std::string& xml_file)
+{
+    std::map<std::string, XMLPluginFile>::iterator loaded_file = loaded_xml_files.find(xml_file);
+    if(loaded_file == loaded_xml_files.end())
+        return;
+
+    for(const PluginInfoPtr& plugin_info : loaded_file->second.classes)
+        removePluginInfo(plugin_info);
+    loaded_xml_files.erase(loaded_file);
+    snapshot_outdated = true;
+    class_hierarchy_outdated = true;
+}
+
+void PluginManager::removePluginInfo(const PluginInfoPtr& plugin_info)
+{
+    ClassIndex::const_iterator existing = classes_available.find(plugin_info->full_class_name_id);
+    if(existing == classes_available.end() || records[existing->second].plugin_info != plugin_info)
+    {
+        eraseFromIndex(classes_shadowed, plugin_info->full_class_name_id, plugin_info);
+        return;
+    }
+
+    unindexRecord(existing->second);
+
+    // a shadowed definition from the next file in sorted order takes over
+    std::pair<std::multimap<StringId, PluginInfoPtr>::iterator, std::multimap<StringId, PluginInfoPtr>::iterator> range;
+    range = classes_shadowed.equal_range(plugin_info->full_class_name_id);
+    std::multimap<StringId, PluginInfoPtr>::iterator next = range.first;
+    for(std::multimap<StringId, PluginInfoPtr>::iterator it = range.first; it != range.second; it++)
+    {
+        if(it->second->xml_file < next->second->xml_file)
+            next = it;
+    }
+    if(next != range.second)
+    {
+        PluginInfoPtr next_plugin_info = next->second;
+        classes_shadowed.erase(next);
+        indexPluginInfo(next_plugin_info);
+    }
+}
+
+void PluginManager::eraseFromIndex(boost::unordered_map< uint64_t, std::vector<uint32_t> >& index, uint64_t key, uint32_t record)
+{
+    boost::unordered_map< uint64_t, std::vector<uint32_t> >::iterator records = index.find(key);
+    if(records == index.end())
+        return;
+    std::vector<uint32_t>::iterator it = std::find(records->second.begin(), records->second.end(), record);
+    if(it != records->second.end())
+        records->second.erase(it);
+    if(records->second.empty())
+        index.erase(records);
+}
+
+void PluginManager::eraseFromIndex(std::multimap<StringId, PluginInfoPtr>& index, StringId key,
+                                   const PluginInfoPtr& plugin_info)
+{
+    std::pair<std::multimap<StringId, PluginInfoPtr>::iterator, std::multimap<StringId, PluginInfoPtr>::iterator> range;
+    range = index.equal_range(key);
+    for(std::multimap<StringId, PluginInfoPtr>::iterator it = range.first; it != range.second; it++)
+    {
+        if(it->second == plugin_info)
+        {
+            index.erase(it);
+            return;
+        }
+    }
+}
+
+bool PluginManager::hasNamespace(const std::string& class_name) const
+{
+    return TypeName(class_name).hasNamespace();
+}
+
+bool PluginManager::hasEmbeddedType(const std::string& class_name) const
+{
+    return TypeName(class_name).hasTemplateArguments();
+}
+
+std::string PluginManager::extractEmbeddedType(const std::string& class_name) const
+{
+    return TypeName(class_name).getTemplateArguments().to_string();
+}
+
+std::string PluginManager::extractBaseType(const std::string& class_name) const
+{
+    return TypeName(class_name).getBaseType().to_string();
+}
+
+std::string PluginManager::removeNamespace(const std::string& class_name) const
+{
+    return TypeName(class_name).getTypeWithoutNamespace().to_string();
+}
+
+void PluginManager::parsePluginMetaInformation(const PluginInfoPtr& plugin_info, TiXmlElement* meta_element)
+{
+    // Can be implemented in inherited classes
+}
+
+void PluginManager::pluginFilesReloaded()
+{
+    // Can be implemented in inherited classes
+}
+
+bool PluginManager::getFullClassName(boost::string_view class_name, std::string& full_class_name) const
+{
+    if(concurrent_readers)
+        return getFullClassName(resolve(class_name), full_class_name);
+
+    uint32_t class_index;
+    if(shared_registry)
+    {
+        if(!findSharedClass(class_name, class_index))
+            return false;
+        full_class_name = shared_registry->getClassField(class_index, RegistryCache::FULL_CLASS_NAME);
+        return true;
+    }
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
+        return false;
+    full_class_name = names.get(record->full_class_name_id);
+    return true;
+}
+
+const PluginInfo* PluginManager::getPluginInfo(boost::string_view class_name) const
+{
+    if(concurrent_readers)
+        return getPluginInfo(resolve(class_name));
+
+    uint32_t class_index;
+    if(shared_registry)
+    {
+        if(!findSharedClass(class_name, class_index))
+            return NULL;
+        // the plugin info is created once per class and kept while the registry is attached
+        PluginInfoPtr plugin_info = getSharedPluginInfo(class_index);
+        ensureClassDetails(plugin_info);
+        return plugin_info.get();
+    }
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
+        return NULL;
+    ensureClassDetails(record->plugin_info);
+    return record->plugin_info.get();
+}
+
+ClassHandle PluginManager::resolve(boost::string_view class_name) const
+{
+    if(concurrent_readers)
+        return resolveSnapshotClass(class_name);
+
+    uint32_t class_index;
+    if(shared_registry)
+    {
+        if(!findSharedClass(class_name, class_index))
+            return ClassHandle();
+        return ClassHandle(getSharedPluginInfo(class_index));
+    }
+
+    const ClassRecord* record = findClassRecord(class_name);
+    if(record == NULL)
+        return ClassHandle();
+    return ClassHandle(record->plugin_info);
+}
+
+ClassHandle PluginManager::resolve(const ClassName& class_name) const
+{
+    // the hash is only valid for canonical names
+    if(concurrent_readers && class_name.isCanonical())
+    {
+        boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+        const PluginInfoPtr* plugin_info = snapshot ? snapshot->findClass(class_name.getName(), class_name.getHash()) : NULL;
+        if(plugin_info != NULL)
+            return ClassHandle(*plugin_info);
+        // e.g. a name without namespace
+        return resolveSnapshotClass(class_name.getName());
+    }
+
+    // the shared registry has no hash index, it is searched by name
+    if(concurrent_readers || shared_registry || !class_name.isCanonical())
+        return resolve(class_name.getName());
+
+    StringId class_name_id;
+    if(!names.find(class_name.getName(), class_name.getHash(), class_name_id))
+    {
+        LOG(WARNING) << "Class " << class_name.getName() << " is unknown.";
+        return ClassHandle();
+    }
+    const ClassRecord* record = findClassRecord(class_name.getName(), class_name_id);
+    if(record == NULL)
+        return ClassHandle();
+    return ClassHandle(record->plugin_info);
+}
+
+bool PluginManager::isClassOfType(const ClassHandle& handle, boost::string_view base_class_name) const
+{
+    std::string canonical_name;
+    return handle.isValid() && handle.getBaseClassName() == TypeName::canonical(base_class_name, canonical_name);
+}
+
+bool PluginManager::getBaseClass(const ClassHandle& handle, std::string& base_class) const
+{
+    if(!handle.isValid())
+        return false;
+    base_class = handle.getBaseClassName();
+    return true;
+}
+
+bool PluginManager::getAssociatedClasses(const ClassHandle& handle, std::vector<std::string>& associated_classes) const
+{
+    if(!handle.isValid())
+        return false;
+    ensureClassDetails(handle.plugin_info);
+    if(handle.plugin_info->associated_classes.empty())
+        return false;
+    associated_classes = handle.plugin_info->associated_classes;
+    return true;
+}
+
+bool PluginManager::getClassDescription(const ClassHandle& handle, std::string& class_description) const
+{
+    if(!handle.isValid())
+        return false;
+    ensureClassDetails(handle.plugin_info);
+    class_description = handle.plugin_info->description;
+    return true;
+}
+
+bool PluginManager::getSingletonFlag(const ClassHandle& handle, bool& is_singleton) const
+{
+    if(!handle.isValid())
+        return false;
+    is_singleton = handle.isSingleton();
+    return true;
+}
+
+bool PluginManager::getClassLibraryPath(const ClassHandle& handle, std::string& library_path) const
+{
+    if(!handle.isValid())
+        return false;
+    library_path = handle.getLibraryPath();
+    return true;
+}
+
+bool PluginManager::getFullClassName(const ClassHandle& handle, std::string& full_class_name) const
+{
+    if(!handle.isValid())
+        return false;
+    full_class_name = handle.getFullClassName();
+    return true;
+}
+
+const PluginInfo* PluginManager::getPluginInfo(const ClassHandle& handle) const
+{
+    if(!handle.isValid())
+        return NULL;
+    ensureClassDetails(handle.plugin_info);
+    return handle.plugin_info.get();
+}
+
+void PluginManager::beginChanges()
+{
+    change_batch_depth++;
+}
+
+void PluginManager::endChanges()
+{
+    if(change_batch_depth == 0)
+    {
+        LOG(WARNING) << "endChanges was called without beginChanges";
+        return;
+    }
+    change_batch_depth--;
+    publishChanges();
+}
+
+void PluginManager::publishChanges()
+{
+    // within a batch the snapshot is published once at its end
+    if(concurrent_readers && change_batch_depth == 0)
+        publishSnapshot();
+}
+
+void PluginManager::publishSnapshot()
+{
+    if(!snapshot_outdated && snapshot)
+        return;
+
+    // the plugin infos are immutable once they are part of a snapshot, they are taken in sorted order
+    std::vector<PluginInfoPtr> available_classes;
+    available_classes.reserve(classes_by_name.size());
+    for(ClassNameIndex::const_iterator it = classes_by_name.begin(); it != classes_by_name.end(); it++)
+    {
+        const PluginInfoPtr& plugin_info = records[it->second].plugin_info;
+        ensureClassDetails(plugin_info);
+        available_classes.push_back(plugin_info);
+    }
+
+    // the class hierarchy is shared with the previous snapshot if the relations haven't changed
+    getClassHierarchy();
+    boost::shared_ptr<const RegistrySnapshot> new_snapshot(new RegistrySnapshot(available_classes, class_hierarchy, meta_index_keys));
+    boost::atomic_store(&snapshot, new_snapshot);
+    snapshot_outdated = false;
+}
+
+ClassHandle PluginManager::resolveSnapshotClass(boost::string_view class_name) const
+{
+    boost::shared_ptr<const RegistrySnapshot> snapshot = getSnapshot();
+    if(!snapshot)
+        return ClassHandle();
+    std::string canonical_name;
+    class_name = TypeName::canonical(class_name, canonical_name);
+
+    const PluginInfoPtr* plugin_info = snapshot->findClass(class_name);
+    if(plugin_info != NULL)
+        return ClassHandle(*plugin_info);
+
+    size_t count = snapshot->findClassesWithoutNamespace(class_name, plugin_info);
+    if(count == 1)
+        return ClassHandle(*plugin_info);
+    else if(count == 0)
+        LOG(WARNING) << "Class " << class_name << " is unknown.";
+    else
+        LOG(WARNING) << "Class " << class_name << " is multiple defined in different namespaces. Please use the full class name.";
+    return ClassHandle();
+}
+
+const ClassHierarchy& PluginManager::getClassHierarchy() const
+{
+    if(!class_hierarchy_outdated)
+        return *class_hierarchy;
+
+    std::vector<BaseClassRelation> classes;
+    std::vector<BaseClassRelation> base_classes;
+    if(shared_registry)
+    {
+        std::vector<uint32_t> class_indexes;
+        shared_registry->getAvailableClassIndexes(class_indexes);
+        classes.reserve(class_indexes.size());
+        for(uint32_t class_index : class_indexes)
+            classes.push_back(BaseClassRelation(shared_registry->getClassField(class_index, RegistryCache::FULL_CLASS_NAME),
+                                                shared_registry->getClassField(class_index, RegistryCache::BASE_CLASS_NAME)));
+        shared_registry->getBaseClasses(base_classes);
+    }
+    else
+    {
+        // the classes are visited in sorted order
+        classes.reserve(classes_by_name.size());
+        for(ClassNameIndex::const_iterator it = classes_by_name.begin(); it != classes_by_name.end(); it++)
+            classes.push_back(BaseClassRelation(it->first.to_string(), names.get(records[it->second].base_class_name_id)));
+        for(const std::pair<const std::string, XMLPluginFile>& loaded_file : loaded_xml_files)
+            base_classes.insert(base_classes.end(), loaded_file.second.base_classes.begin(), loaded_file.second.base_classes.end());
+    }
+    std::sort(base_classes.begin(), base_classes.end());
+
+    // most changes, e.g. a modified description or a reloaded library, keep the relations
+    if(!class_hierarchy || classes != class_hierarchy_classes || base_classes != class_hierarchy_base_classes)
+    {
+        boost::shared_ptr<ClassHierarchy> updated_hierarchy(new ClassHierarchy);
+        for(const BaseClassRelation& relation : classes)
+            updated_hierarchy->addClass(relation.first, relation.second);
+        for(const BaseClassRelation& base_class : base_classes)
+            updated_hierarchy->addBaseClass(base_class.first, base_class.second);
+        updated_hierarchy->update();
+        class_hierarchy = updated_hierarchy;
+        class_hierarchy_classes.swap(classes);
+        class_hierarchy_base_classes.swap(base_classes);
+    }
+    class_hierarchy_outdated = false;
+    return *class_hierarchy;
+}
+
+boost::shared_ptr<const RegistrySnapshot> PluginManager::getSnapshot() const
+{
+    return boost::atomic_load(&snapshot);
+}
+
+const PluginManager::ClassRecord* PluginManager::findClassRecord(boost::string_view class_name) const
+{
+    // the registered names are canonical, e.g. Item<int > is registered as Item<int>
+    std::string canonical_name;
+    class_name = TypeName::canonical(class_name, canonical_name);
+
+    // names which are not in the pool can't be registered
+    StringId class_name_id;
+    if(!names.find(class_name, class_name_id))
+    {
+        LOG(WARNING) << "Class " << class_name << " is unknown.";
+        return NULL;
+    }
+    return findClassRecord(class_name, class_name_id);
+}
+
+const PluginManager::ClassRecord* PluginManager::findClassRecord(boost::string_view class_name, StringId class_name_id) const
+{
+    ClassIndex::const_iterator record = classes_available.find(class_name_id);
+    if(record != classes_available.end())
+    {
+        // even if class_name doesn't have a namespace, this is all information we have
+        return &records[record->second];
+    }
+
+    size_t count = classes_no_ns_available.count(class_name_id);
+    if(count == 1)
+        return &records[classes_no_ns_available.find(class_name_id)->second];
+    else if(count == 0)
+        LOG(WARNING) << "Class " << class_name << " is unknown.";
+    else
+        LOG(WARNING) << "Class " << class_name << " is multiple defined in different namespaces. Please use the full class name.";
+    return NULL;
 }
\ No newline at end of file
@@ -4,14 +4,27 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <mutex>
+#include <stdint.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/utility/string_view.hpp>
+#include <boost/unordered_map.hpp>
 #include "PluginInfo.hpp"
+#include "XMLPluginFile.hpp"
+#include "StringPool.hpp"
+#include "NodeArena.hpp"
+#include "ClassHandle.hpp"
+#include "ClassName.hpp"
+#include "ClassHierarchy.hpp"
 
 class TiXmlElement;
 
 namespace plugin_manager
 {
 
+class RegistryCache;
+class RegistrySnapshot;
+
 /**
  * @class PluginManager
  * @brief A class to load xml plugin informations
@@ -26,9 +39,11 @@ public:
      * @param plugin_xml_paths The list of paths of plugin.xml files
      * @param load_environment_paths true if environment path shall be loaded
      * @param auto_load_xml_files if this is false reloadXMLPluginFiles must be triggered by a inherited class or manually
+     * @param registry_cache_file path to a registry cache file, see setRegistryCacheFile
      */
     PluginManager(const std::vector<std::string>& plugin_xml_paths = std::vector<std::string>(),
-                  bool load_environment_paths = true, bool auto_load_xml_files = true);
+                  bool load_environment_paths = true, bool auto_load_xml_files = true,
+                  const std::string& registry_cache_file = std::string());
 
     /**
      * @brief Destructor for PluginManager
@@ -49,17 +64,42 @@ public:
 
     /**
      * @brief Returns a list of all available classes for the given base class type
+     * Note: The classes used to be returned in the order of the xml files, they are sorted by name now.
      * @param base_class name of the base class
-     * @return A vector of strings corresponding to the names of all available classes
+     * @return A vector of strings corresponding to the names of all available classes in sorted order
      */
     std::vector<std::string> getAvailableClasses(const std::string& base_class) const;
 
+    /**
+     * @brief Returns a list of all available classes for the given base class type
+     * @param base_class name of the base class
+     * @param transitive if true classes which inherit indirectly from the base class are included, see isSubclassOf
+     * @return A vector of strings corresponding to the names of all available classes in sorted order
+     */
+    std::vector<std::string> getAvailableClasses(const std::string& base_class, bool transitive) const;
+
+    /**
+     * @brief Returns true if the class inherits directly or indirectly from the given base class.
+     * The hierarchy consists of the base classes of the registered classes and of base class
+     * relations of other types declared in the xml files:
+     * <base_class class_name="envire::core::Item" base_class_name="envire::core::ItemBase"/>
+     * @param class_name the name of the plugin class, with or without namespace
+     * @param base_class_name the full name of the base class
+     * @return True if the class inherits from the base class
+     */
+    bool isSubclassOf(boost::string_view class_name, boost::string_view base_class_name) const;
+
+    /**
+     * @brief Returns true if a resolved class inherits directly or indirectly from the given base class
+     */
+    bool isSubclassOf(const ClassHandle& handle, boost::string_view base_class_name) const;
+
     /**
      * @brief Return true if the given class is registered.
      * @param class_name the name of the plugin class
      * @return True if class could be found
      */
-    bool isClassInfoAvailable(const std::string& class_name) const;
+    bool isClassInfoAvailable(boost::string_view class_name) const;
 
     /**
      * @brief Returns the base class of the given class
@@ -67,7 +107,14 @@ public:
      * @param base_class the base class name
      * @return True if base class could be found
      */
-    bool getBaseClass(const std::string& class_name, std::string& base_class) const;
+    bool getBaseClass(boost::string_view class_name, std::string& base_class) const;
+
+    /**
+     * @brief Returns true if the class is registered and inherits from the given base class
+     * @param class_name the name of the plugin class
+     * @param base_class_name the name of the base class
+     */
+    bool isClassOfType(boost::string_view class_name, boost::string_view base_class_name) const;
 
     /**
      * @brief Returns a vector of all associated classes of the given class.
@@ -76,7 +123,7 @@ public:
      * @param associated_classes names of the associated classes
      * @return True if an associated class was found
      */
-    bool getAssociatedClasses(const std::string& class_name, std::vector<std::string>& associated_classes) const;
+    bool getAssociatedClasses(boost::string_view class_name, std::vector<std::string>& associated_classes) const;
 
     /**
      * @brief Returns the description of the given class
@@ -84,7 +131,7 @@ public:
      * @param class_description the class description
      * @return True if plugin description could be found
      */
-    bool getClassDescription(const std::string& class_name, std::string& class_description) const;
+    bool getClassDescription(boost::string_view class_name, std::string& class_description) const;
 
     /**
      * @brief Returns if the class should be treated as singleton
@@ -92,7 +139,7 @@ public:
      * @param is_singleton true if marked as singleton
      * @return True if plugin description could be found
      */
-    bool getSingletonFlag(const std::string& class_name, bool& is_singleton) const;
+    bool getSingletonFlag(boost::string_view class_name, bool& is_singleton) const;
 
     /**
      * @brief Returns the library path of the given class
@@ -100,7 +147,7 @@ public:
      * @param library_path the library path of the plugin
      * @return True if the library path could be found
      */
-    bool getClassLibraryPath(const std::string& class_name, std::string& library_path) const;
+    bool getClassLibraryPath(boost::string_view class_name, std::string& library_path) const;
 
     /**
      * @brief Return the full class name of a given class
@@ -108,19 +155,104 @@ public:
      * @param full_class_name class name with namespace
      * @return True if class coudl be found
      */
-    bool getFullClassName(const std::string& class_name, std::string& full_class_name) const;
+    bool getFullClassName(boost::string_view class_name, std::string& full_class_name) const;
+
+    /**
+     * @brief Returns the plugin information of a class without copying it.
+     * The optional fields are loaded if they haven't been loaded yet.
+     * Note: The pointer is valid until the plugin informations are reloaded, removed or cleared.
+     * @param class_name the name of the plugin class, with or without namespace
+     * @return The plugin information or NULL if the class could not be found
+     */
+    const PluginInfo* getPluginInfo(boost::string_view class_name) const;
+
+    /**
+     * @brief Resolves a class name once, the handle can be used for all further queries of the class
+     * @param class_name the name of the plugin class, with or without namespace
+     * @return The handle of the class, it is invalid if the class could not be found
+     */
+    ClassHandle resolve(boost::string_view class_name) const;
+
+    /**
+     * @brief Resolves a class name with a precomputed hash, e.g. resolve(PLUGIN_CLASS("envire::StringPlugin"))
+     * The hash is used for canonical names in the process local registry and with concurrent readers.
+     * An attached shared registry has no hash index, there the class is looked up by name like by resolve.
+     * @param class_name the name of the plugin class, with or without namespace
+     * @return The handle of the class, it is invalid if the class could not be found
+     */
+    ClassHandle resolve(const ClassName& class_name) const;
+
+    /**
+     * @brief Returns true if the class of the handle inherits from the given base class
+     */
+    bool isClassOfType(const ClassHandle& handle, boost::string_view base_class_name) const;
+
+    /**
+     * @brief Returns the base class of a resolved class
+     * @return True if the handle is valid
+     */
+    bool getBaseClass(const ClassHandle& handle, std::string& base_class) const;
+
+    /**
+     * @brief Returns the associated classes of a resolved class
+     * @return True if the class has associated classes
+     */
+    bool getAssociatedClasses(const ClassHandle& handle, std::vector<std::string>& associated_classes) const;
+
+    /**
+     * @brief Returns the description of a resolved class
+     * @return True if the handle is valid
+     */
+    bool getClassDescription(const ClassHandle& handle, std::string& class_description) const;
+
+    /**
+     * @brief Returns the singleton flag of a resolved class
+     * @return True if the handle is valid
+     */
+    bool getSingletonFlag(const ClassHandle& handle, bool& is_singleton) const;
+
+    /**
+     * @brief Returns the library path of a resolved class
+     * @return True if the handle is valid
+     */
+    bool getClassLibraryPath(const ClassHandle& handle, std::string& library_path) const;
+
+    /**
+     * @brief Returns the full class name of a resolved class
+     * @return True if the handle is valid
+     */
+    bool getFullClassName(const ClassHandle& handle, std::string& full_class_name) const;
+
+    /**
+     * @brief Returns the plugin information of a resolved class, the optional fields are loaded if necessary
+     * @return The plugin information or NULL if the handle is invalid
+     */
+    const PluginInfo* getPluginInfo(const ClassHandle& handle) const;
 
     /**
      * @brief Returns the name of a class which inherits from the given
      *        base class and is associated to the given embedded type.
      * Note: If more than one associated class is available it will always
-     *       return the first one that is found.
+     *       return the first one in sorted order. It used to be the first one
+     *       in the order of the xml files.
+     *       Use getAssociatedClassesOfType to choose between them.
      * @param embedded_type name of the embedded type
      * @param base_class_name name of the base class
      * @param associated_class name of the associated class
      * @return True if an associated class could be found
      */
-    bool getAssociatedClassOfType(const std::string& embedded_type, const std::string& base_class_name, std::string& associated_class) const;
+    bool getAssociatedClassOfType(boost::string_view embedded_type, boost::string_view base_class_name, std::string& associated_class) const;
+
+    /**
+     * @brief Returns the names of all classes which inherit from the given
+     *        base class and are associated to the given embedded type.
+     * In lazy mode this parses the xml files of the classes of the base class whose
+     * details aren't loaded yet, see loadAllClassDetails.
+     * @param embedded_type name of the embedded type
+     * @param base_class_name name of the base class
+     * @return The full class names in sorted order
+     */
+    std::vector<std::string> getAssociatedClassesOfType(boost::string_view embedded_type, boost::string_view base_class_name) const;
 
     /**
      * @brief Returns the libraries that are registered and can be loaded
@@ -130,16 +262,87 @@ public:
 
     /**
      * @brief Removes the class info of the given class
+     * Note: The class info will be restored by the next call of reloadXMLPluginFiles.
      * @param class_name the name of the plugin class
      * @return True if the class was found and removed
      */
     bool removeClassInfo(const std::string& class_name);
 
+    /**
+     * @brief Removes the class infos of all classes of a library
+     * Note: The class infos will be restored by the next call of reloadXMLPluginFiles.
+     * @param library_path the library path as given in the xml files
+     * @return The number of classes removed
+     */
+    size_t removeLibrary(boost::string_view library_path);
+
+    /**
+     * @brief Removes the class infos of all classes of a base class
+     * Note: The class infos will be restored by the next call of reloadXMLPluginFiles.
+     * @param base_class_name the full name of the base class
+     * @return The number of classes removed
+     */
+    size_t removeClassesOfType(boost::string_view base_class_name);
+
+    /**
+     * @brief Returns the classes of a library
+     * @param library_path the library path as given in the xml files
+     * @return The full class names in sorted order
+     */
+    std::vector<std::string> getLibraryClasses(boost::string_view library_path) const;
+
+    /**
+     * @brief Adds an index over the values of a meta attribute, see PluginInfo::meta_attributes
+     * The index is kept until the plugin manager is destroyed, clear and reloads update it.
+     * With concurrent readers the index is part of the published snapshots. An attached shared
+     * registry indexes all meta attributes, unless it was written in lazy mode without the details.
+     * @param key the key of the meta attribute, e.g. user_tag.frame_name
+     */
+    void addMetaIndex(const std::string& key);
+
+    /**
+     * @brief Returns the classes which have a meta attribute with the given value.
+     * Classes are only looked up by index if the key has one or the shared registry is attached,
+     * see addMetaIndex. Otherwise the meta attributes of all classes are compared.
+     * In lazy mode this parses the xml files of the classes whose details aren't loaded yet,
+     * see loadAllClassDetails.
+     * @param key the key of the meta attribute, e.g. user_tag.frame_name
+     * @param value the value of the meta attribute
+     * @param base_class_name if not empty only classes of this base class are returned
+     * @return The full class names in sorted order
+     */
+    std::vector<std::string> getClassesWithMeta(boost::string_view key, boost::string_view value,
+                                                boost::string_view base_class_name = boost::string_view()) const;
+
+    /**
+     * @brief Returns the classes of a namespace, including the classes of nested namespaces
+     * @param name_space the namespace, e.g. envire::viz
+     * @param base_class_name if not empty only classes of this base class are returned
+     * @return The full class names in sorted order
+     */
+    std::vector<std::string> getClassesInNamespace(boost::string_view name_space,
+                                                   boost::string_view base_class_name = boost::string_view()) const;
+
+    /**
+     * @brief Returns the classes whose full name starts with the given prefix
+     * @param prefix the prefix of the full class names, e.g. envire::viz::Item
+     * @param base_class_name if not empty only classes of this base class are returned
+     * @return The full class names in sorted order
+     */
+    std::vector<std::string> getClassesWithPrefix(boost::string_view prefix,
+                                                  boost::string_view base_class_name = boost::string_view()) const;
+
     /**
      * @brief Clears all plugin informations.
      */
     virtual void clear();
 
+    /**
+     * @brief Returns the number of distinct names stored by the registry, mainly for diagnostics.
+     * Names of removed classes are released once they make up more than half of the names.
+     */
+    size_t getInternedNameCount() const;
+
     /**
      * @brief Overrides the paths of the xml plugin informations.
      *        This also removes all currently known paths.
@@ -149,9 +352,154 @@ public:
 
     /**
      * @brief Loads all plugin informations found in the given xml plugin paths.
+     * The reload is incremental, only files that are new or have changed since the
+     * last reload are parsed. Classes of files that have been deleted are removed.
+     * The files are parsed on the configured number of worker threads, see setReloadWorkerThreads.
+     * Independent of the number of workers and the order of changes a class is always
+     * provided by the first file in sorted order that defines it.
      */
     void reloadXMLPluginFiles();
 
+    /**
+     * @brief Sets the number of worker threads used to parse the xml plugin files.
+     * Note: If more than one worker is used, parsePluginMetaInformation may be
+     *       called concurrently and must be thread-safe in inherited classes.
+     * @param worker_threads number of parallel workers, 0 uses one worker per available core.
+     *        The default is 1, which parses all files sequentially in the calling thread.
+     */
+    void setReloadWorkerThreads(unsigned int worker_threads);
+
+    /**
+     * @brief Returns the number of worker threads used to parse the xml plugin files.
+     */
+    unsigned int getReloadWorkerThreads() const;
+
+    /**
+     * @brief Enables or disables the lazy loading of plugin informations.
+     * In lazy mode reloadXMLPluginFiles only records the class name, base class,
+     * library path and singleton flag of each class. The description, the associated
+     * classes and the meta information are loaded from the xml file on the first
+     * call of getClassDescription, getAssociatedClasses or loadClassDetails.
+     * This applies to all files that are parsed after the mode was changed.
+     * @param lazy_loading true to enable the lazy loading
+     */
+    void setLazyLoading(bool lazy_loading);
+
+    /**
+     * @brief Returns true if the lazy loading is enabled
+     */
+    bool getLazyLoading() const;
+
+    /**
+     * @brief Loads the details of all classes whose details aren't loaded yet and adds
+     *        their associations and meta attributes to the indexes.
+     * In lazy mode the association and meta queries check these classes one by one,
+     * since const queries don't change the indexes.
+     */
+    void loadAllClassDetails();
+
+    /**
+     * @brief Loads the description, the associated classes and the meta information
+     *        of the given class if this hasn't been done yet.
+     * In lazy mode this also calls parsePluginMetaInformation for the class.
+     * @param class_name the name of the plugin class
+     * @return True if the details of the class are available
+     */
+    bool loadClassDetails(boost::string_view class_name) const;
+
+    /**
+     * @brief Sets the path of the registry cache file.
+     * The cache stores the parsed plugin informations of all xml files together with
+     * their size, modification time and inode. On reload only files that changed
+     * since the cache was written are parsed again, afterwards the cache is updated.
+     * @param registry_cache_file path to the cache file, an empty string disables the cache
+     */
+    void setRegistryCacheFile(const std::string& registry_cache_file);
+
+    /**
+     * @brief Returns the path of the registry cache file, empty if no cache is used
+     */
+    const std::string& getRegistryCacheFile() const;
+
+    /**
+     * @brief Compiles all xml plugin files of a folder into a registry bundle.
+     * The bundle is stored as plugin_registry.bundle in the folder. On reload the bundle
+     * is used instead of parsing the xml files as long as it covers exactly the xml files
+     * found in the folder. Each file is only taken from the bundle if its size, modification
+     * time and inode are unchanged, files changed after the bundle was written are parsed.
+     * The bundle should be written again after the xml files have been changed, this is
+     * done by the plugin_manager_bundle tool when plugin infos are installed.
+     * @param plugin_xml_folder the folder containing the xml files
+     * @return True if the bundle was written
+     */
+    bool writeRegistryBundle(const std::string& plugin_xml_folder);
+
+    /**
+     * @brief Enables the shared memory registry.
+     * The first process parses the xml files and places the registry in a read only
+     * POSIX shared memory segment. Later processes with the same plugin xml paths attach
+     * to the segment on reload, as long as the xml files didn't change, and answer
+     * queries directly from it without building their own registry.
+     * If the xml files changed or the registry is modified by removeClassInfo the
+     * process continues with its own copy of the registry and replaces the segment.
+     * Segments are only shared between processes of the same effective user, they can't be
+     * accessed by other users and segments created by other users are ignored.
+     * The default is taken from the environment variable PLUGIN_MANAGER_SHARED_REGISTRY.
+     * @param shared_registry_name base name of the shared memory segment, an empty string disables it
+     */
+    void setSharedRegistry(const std::string& shared_registry_name);
+
+    /**
+     * @brief Returns the base name of the shared memory segment, empty if it is disabled
+     */
+    const std::string& getSharedRegistry() const;
+
+    /**
+     * @brief Returns true if queries are answered by a shared registry of another process
+     */
+    bool isSharedRegistryAttached() const;
+
+    /**
+     * @brief Removes the shared memory segment of the current plugin xml paths.
+     * Processes which are attached to it keep using it.
+     */
+    void removeSharedRegistry() const;
+
+    /**
+     * @brief Enables concurrent readers.
+     * In this mode every change of the registry, i.e. a reload or a removal, is published as an
+     * immutable snapshot by replacing an atomic pointer. Several changes can be published at once,
+     * see beginChanges. All const queries are answered from the
+     * current snapshot, so any number of threads can query the registry without further
+     * synchronization while a reload is built next to it. Changes must still be made by one
+     * thread at a time.
+     * The optional fields of all classes are loaded before a snapshot is published, lazy loading
+     * only defers them to the end of the reload. The shared registry isn't attached in this mode.
+     * Note: Pointers returned by getPluginInfo can be invalidated by the next change, prefer
+     *       a ClassHandle which keeps the plugin info alive.
+     * Enable or disable this mode before readers are started.
+     * @param concurrent_readers true to enable the mode, the default is false
+     */
+    void setConcurrentReaders(bool concurrent_readers);
+
+    /**
+     * @brief Returns true if concurrent readers are enabled
+     */
+    bool getConcurrentReaders() const;
+
+    /**
+     * @brief Starts a batch of changes, e.g. several removals.
+     * With concurrent readers the snapshot is only published once at the end of the batch
+     * instead of after every change. Batches can be nested.
+     */
+    void beginChanges();
+
+    /**
+     * @brief Ends a batch of changes, see beginChanges.
+     * The changes are published when the outermost batch ends.
+     */
+    void endChanges();
+
 protected:
     /**
      * @brief Returns true if the given class name has a namespace
@@ -182,10 +530,44 @@ protected:
 
     /**
      * @brief Can be overloaded to parse meta information related to a plugin.
+     * The meta element is only parsed into a document if this is overloaded,
+     * its attributes are always available in PluginInfo::meta_attributes.
      */
     virtual void parsePluginMetaInformation(const PluginInfoPtr& plugin_info, TiXmlElement* meta_element);
 
+    /**
+     * @brief Can be overloaded to update state that depends on the registry,
+     *        it is called at the end of reloadXMLPluginFiles.
+     */
+    virtual void pluginFilesReloaded();
+
 private:
+    typedef ArenaAllocator< std::pair<const StringId, uint32_t> > IndexAllocator;
+    typedef std::map<StringId, uint32_t, std::less<StringId>, IndexAllocator> ClassIndex;
+    typedef std::multimap<StringId, uint32_t, std::less<StringId>, IndexAllocator> ClassMultiIndex;
+    typedef ArenaAllocator< std::pair<const boost::string_view, uint32_t> > NameIndexAllocator;
+    typedef std::map<boost::string_view, uint32_t, std::less<boost::string_view>, NameIndexAllocator> ClassNameIndex;
+
+    /**
+     * Index addressed record of an available class. The fields needed by the indexes and
+     * the lookups are stored contiguously, the other fields are kept in the plugin info.
+     */
+    struct ClassRecord
+    {
+        StringId full_class_name_id;
+        StringId class_name_id;
+        StringId base_class_name_id;
+        StringId library_path_id;
+        /** True if the associated classes and the indexed meta attributes have been added to their indexes */
+        bool details_indexed;
+        /** Null if the record is unused */
+        PluginInfoPtr plugin_info;
+        /** Entries of the record in the multi indexes, so it is removed without searching the index */
+        ClassMultiIndex::iterator base_class_entry;
+        ClassMultiIndex::iterator class_name_entry;
+        ClassMultiIndex::iterator library_entry;
+    };
+
     /**
      * @brief Returns the paths in all install folders set by the environment.
      * @return A vector of paths
@@ -193,19 +575,116 @@ private:
     std::vector<std::string> getPluginXmlPathsFromEnv() const;
 
     /**
-     * @brief Returns the available xml files in the given folder
-     * @param plugin_xml_folder a plugin information folder
-     * @param plugin_xml_files a set of all xml files
+     * @brief Processes a xml plugin info file
+     * @param plugin_file the xml file containing plugin information, the plugin infos found are added to it
+     * @param parse_details if false the optional fields are loaded on demand
+     * @param keep_meta_elements if true the meta elements are stored in the plugin file
+     * @return True if xml was successfully parsed
      */
-    void determineAvailableXMLPluginFiles(const std::string& plugin_xml_folder, std::set<std::string>& plugin_xml_files) const;
+    bool processSingleXMLPluginFile(XMLPluginFile& plugin_file, bool parse_details, bool keep_meta_elements);
 
     /**
-     * @brief Processes a xml plugin info file
-     * @param xml_file a xml file containing plugin information
-     * @param class_available A vector of all plugin infos found
-     * @return True if xml was successfully parsed
+     * @brief Calls parsePluginMetaInformation for a serialized meta element.
+     * The document is only built if an inherited class implements the callback.
+     * @param plugin_info the plugin info the meta element belongs to
+     * @param meta_element the meta element as xml string, nothing is done if it is empty
      */
-    bool processSingleXMLPluginFile(const std::string& xml_file, std::vector<PluginInfoPtr>& class_available);
+    void processMetaInformation(const PluginInfoPtr& plugin_info, const std::string& meta_element);
+
+    /**
+     * @brief Sets the meta attributes of a plugin info from a serialized meta element, e.g. of the registry cache
+     */
+    static void restoreMetaAttributes(const PluginInfoPtr& plugin_info, const std::string& meta_element);
+
+    /**
+     * @brief Returns true if the dynamic type implements parsePluginMetaInformation.
+     * Only GCC allows to compare the callbacks, otherwise true is returned.
+     */
+    bool overridesMetaInformationCallback() const;
+
+    /**
+     * @brief Loads the optional fields of a class from its xml file if they are missing.
+     * Safe to call from several threads, the plugin infos of a snapshot are complete and need no lock.
+     * @param plugin_info the plugin info to fill
+     * @return True if the details of the class are available
+     */
+    bool ensureClassDetails(const PluginInfoPtr& plugin_info) const;
+
+    /**
+     * @brief Reads the registry bundle of a folder if it matches the xml files found in it
+     * @param plugin_xml_folder the folder
+     * @param xml_files the xml files found in the folder
+     * @param bundled_files the plugin files of the bundle which are unchanged on disk are added to it, indexed by path
+     */
+    void loadRegistryBundle(const std::string& plugin_xml_folder, const std::vector<std::string>& xml_files,
+                            std::map<std::string, FileFingerprint>& bundled_files) const;
+
+    /**
+     * @brief Reads the plugin infos of a xml file from the registry bundle of its folder
+     * @param plugin_file the plugin file, its path and fingerprint must be set
+     * @param bundles the bundles mapped during this reload, indexed by folder
+     * @return True if the file was found in the bundle
+     */
+    bool loadBundledFile(XMLPluginFile& plugin_file, std::map<std::string, boost::shared_ptr<RegistryCache> >& bundles);
+
+    /**
+     * @brief Returns the name of the shared memory segment for the current plugin xml paths
+     */
+    std::string getSharedRegistrySegment() const;
+
+    /**
+     * @brief Returns true if the registry was created from the xml files with the given fingerprints
+     */
+    static bool matchesSharedRegistry(const RegistryCache& registry, const std::map<std::string, FileFingerprint>& fingerprints);
+
+    /**
+     * @brief Attaches to the shared registry if it was created from the given xml files
+     * @param fingerprints the current xml files and their fingerprints
+     * @return True if the shared registry is used
+     */
+    bool attachSharedRegistry(const std::map<std::string, FileFingerprint>& fingerprints);
+
+    /**
+     * @brief Copies the content of the attached shared registry into the process and detaches from it
+     */
+    void detachSharedRegistry();
+
+    /**
+     * @brief Finds a class in the attached shared registry, like getFullClassName does
+     */
+    bool findSharedClass(boost::string_view class_name, uint32_t& class_index) const;
+
+    /**
+     * @brief Returns true if the details of a class can be read directly from the shared registry
+     */
+    bool hasSharedClassDetails(uint32_t class_index) const;
+
+    /**
+     * @brief Returns the plugin info of a class of the attached shared registry.
+     * Plugin infos are only created for classes which need them, e.g. for the meta information callback.
+     * Safe to call from several threads.
+     */
+    PluginInfoPtr getSharedPluginInfo(uint32_t class_index) const;
+
+    /**
+     * @brief Returns true if the optional fields of all classes of the file are loaded
+     */
+    static bool hasAllClassDetails(const XMLPluginFile& plugin_file);
+
+    /**
+     * @brief Processes all xml plugin info files which aren't marked as processed,
+     *        using the configured number of workers
+     * @param plugin_files the xml files to process
+     * @param processed_files is set to true for each xml file that was successfully parsed
+     */
+    void processXMLPluginFiles(std::vector<XMLPluginFile>& plugin_files, std::vector<bool>& processed_files);
+
+    /**
+     * @brief Calls parsePluginMetaInformation for the serialized meta elements
+     *        of a plugin file which was loaded from the registry cache
+     * @param plugin_file a plugin file loaded from the registry cache
+     */
+    void restoreMetaInformation(const XMLPluginFile& plugin_file);
 
     /**
      * @brief Insert plugin infos to internal data structure
@@ -213,18 +692,257 @@ private:
      */
     void insertPluginInfos(const std::vector<PluginInfoPtr>& classes);
 
+    /**
+     * @brief Adds the plugin infos of a xml file to the internal data structure
+     * and keeps track of the file
+     * @param plugin_file the parsed xml file
+     */
+    void insertXMLPluginFile(const XMLPluginFile& plugin_file);
+
+    /**
+     * @brief Removes all plugin infos of a previously loaded xml file
+     * @param xml_file path of the xml file
+     */
+    void removeXMLPluginFile(const std::string& xml_file);
+
+    /**
+     * @brief Removes a plugin info from the internal data structure.
+     * If another xml file defines the same class its plugin info takes over.
+     * @param plugin_info the plugin info to remove
+     */
+    void removePluginInfo(const PluginInfoPtr& plugin_info);
+
+    /**
+     * @brief Removes a plugin info from the given index
+     * @param index a mapping between names and plugin infos
+     * @param key the name the plugin info is stored with
+     * @param plugin_info the plugin info to remove
+     */
+    static void eraseFromIndex(std::multimap<StringId, PluginInfoPtr>& index, StringId key,
+                               const PluginInfoPtr& plugin_info);
+
+    /**
+     * @brief Interns the names of a plugin info and sets their ids
+     */
+    void internNames(PluginInfo& plugin_info);
+
+    /**
+     * @brief Adds a record for an available plugin info and adds it to the indexes
+     */
+    void indexPluginInfo(const PluginInfoPtr& plugin_info);
+
+    /**
+     * @brief Removes a record from the indexes, the record is reused by the next class
+     */
+    void unindexRecord(uint32_t record);
+
+    /**
+     * @brief Removes an available class until the next reload
+     */
+    void removeRecord(uint32_t record);
+
+    /**
+     * @brief Removes all classes of a multi index entry until the next reload
+     * @return The number of classes removed
+     */
+    size_t removeRecords(const ClassMultiIndex& index, boost::string_view key);
+
+    /**
+     * @brief Adds the associated classes and the indexed meta attributes of a record with loaded details to their indexes
+     */
+    void indexClassDetails(uint32_t record);
+
+    /**
+     * @brief Adds a meta attribute of a record to the meta index
+     */
+    void indexMetaAttribute(uint32_t record, const MetaAttribute& meta_attribute);
+
+    /**
+     * @brief Loads the details of the classes of a base class which are not in the association and meta indexes yet
+     */
+    void loadPendingDetails(StringId base_class_name_id);
+
+    /**
+     * @brief Removes a record from an entry of the association or meta index
+     */
+    static void eraseFromIndex(boost::unordered_map< uint64_t, std::vector<uint32_t> >& index, uint64_t key, uint32_t record);
+
+    /**
+     * @brief Returns the records of the classes of a base class associated to an embedded type
+     * @param associated_records the records found, the indexed ones first
+     * @return False if there are none
+     */
+    bool findAssociatedRecords(boost::string_view embedded_type, boost::string_view base_class_name,
+                               std::vector<uint32_t>& associated_records) const;
+
+    /**
+     * @brief Returns the key of the association and the meta index, i.e. of a pair of names
+     */
+    static uint64_t indexKey(StringId first_id, StringId second_id);
+
+    /**
+     * @brief Publishes a new snapshot if the registry has changed since the last one
+     */
+    void publishSnapshot();
+
+    /**
+     * @brief Publishes the changes with concurrent readers unless a batch of changes is open
+     */
+    void publishChanges();
+
+    /**
+     * @brief Resolves a class name in the current snapshot
+     */
+    ClassHandle resolveSnapshotClass(boost::string_view class_name) const;
+
+    /**
+     * @brief Returns the current snapshot
+     */
+    boost::shared_ptr<const RegistrySnapshot> getSnapshot() const;
+
+    /**
+     * @brief Returns the class hierarchy of the available classes.
+     * If the registry has changed the relations are collected again, the closure is only computed
+     * again if they differ from the relations of the current hierarchy.
+     */
+    const ClassHierarchy& getClassHierarchy() const;
+
+    /**
+     * @brief Reloads the registry, see reloadXMLPluginFiles
+     */
+    void reloadRegistry();
+
+    /**
+     * @brief Removes all classes from the indexes and clears the string pool
+     */
+    void clearIndexes();
+
+    /**
+     * @brief Rebuilds the string pool and the indexes from the registered classes if the pool
+     *        has grown to more than twice its size after the last rebuild. The pool is append only,
+     *        so the names of removed and changed classes would otherwise accumulate.
+     */
+    void compactNames();
+
+    /**
+     * @brief Returns the record of an available class
+     * @param class_name the class name with or without namespace
+     * @return The record or NULL if the class is unknown or ambiguous
+     */
+    const ClassRecord* findClassRecord(boost::string_view class_name) const;
+
+    /**
+     * @brief Returns the record of an available class by the id of its name
+     * @param class_name the name of the class, used for warnings
+     * @param class_name_id the id of the class name
+     */
+    const ClassRecord* findClassRecord(boost::string_view class_name, StringId class_name_id) const;
+
 private:
     /** Path to the folders where the xml files can be found */
     std::vector<std::string> plugin_xml_paths;
 
-    /** Mapping between full class name and plugin information */
-    std::map<std::string, PluginInfoPtr> classes_available;
+    /** Number of worker threads used to parse the xml files */
+    unsigned int reload_worker_threads;
+
+    /** Path to the registry cache file, empty if the cache is disabled */
+    std::string registry_cache_file;
+
+    /** True if the optional fields of the classes are loaded on demand */
+    bool lazy_loading;
+
+    /** Pool of the class, base class and library names, the indexes below are keyed by its ids */
+    StringPool names;
+
+    /** Number of names in the pool after it was compacted the last time, see compactNames */
+    size_t live_name_count;
+
+    /** Records of the available classes */
+    std::vector<ClassRecord> records;
+
+    /** Unused records */
+    std::vector<uint32_t> free_records;
+
+    /** Memory of the index nodes, it has to be declared before the indexes */
+    NodeArena index_arena;
+
+    /** Mapping between full class name and class record */
+    ClassIndex classes_available;
+
+    /** Mapping between full class name and class record in sorted order of the names,
+     *  the keys are views on the strings in the pool */
+    ClassNameIndex classes_by_name;
+
+    /** Mapping between base class name and corresponding class records */
+    ClassMultiIndex base_classes_available;
+
+    /** Mapping between class name without namespace and class record */
+    ClassMultiIndex classes_no_ns_available;
+
+    /** Mapping between library path and class records */
+    ClassMultiIndex libraries_available;
+
+    /** Mapping between associated type and base class name, see indexKey, and class records */
+    boost::unordered_map< uint64_t, std::vector<uint32_t> > associations_available;
+
+    /** Mapping between meta attribute key and value, see indexKey, and class records */
+    boost::unordered_map< uint64_t, std::vector<uint32_t> > meta_available;
+
+    /** The keys of the meta attributes which are indexed */
+    std::set<std::string> meta_index_keys;
+
+    /** Number of records per base class whose details are not loaded yet, so their
+     *  associations and meta attributes are missing in the indexes */
+    std::map<StringId, size_t> pending_details;
+
+    /** Mapping between full class name and plugin informations that are hidden by a
+     *  definition of the same class in a file that comes first in sorted order */
+    std::multimap<StringId, PluginInfoPtr> classes_shadowed;
+
+    /** The xml files loaded by the last reload, with their fingerprints */
+    std::map<std::string, XMLPluginFile> loaded_xml_files;
+
+    /** Base name of the shared memory segment, empty if the shared registry is disabled */
+    std::string shared_registry_name;
+
+    /** The attached shared registry, the indexes above are empty while it is attached */
+    boost::shared_ptr<RegistryCache> shared_registry;
+
+    /** Plugin infos created for classes of the shared registry, indexed by class record */
+    mutable std::map<uint32_t, PluginInfoPtr> shared_plugin_infos;
+
+    /** Guards shared_plugin_infos and the lazy loading of class details, both happen in const queries.
+     *  It is recursive since parsePluginMetaInformation may query the plugin manager. */
+    mutable std::recursive_mutex details_mutex;
+
+    /** True if the queries are answered from the published snapshot */
+    bool concurrent_readers;
+
+    /** True if the registry has changed since the last snapshot was published */
+    bool snapshot_outdated;
+
+    /** The class hierarchy of the process local registry or the shared registry, see getClassHierarchy.
+     *  It is shared with the published snapshots and only replaced if the relations have changed. */
+    mutable boost::shared_ptr<const ClassHierarchy> class_hierarchy;
+
+    /** The class relations and the declared base class relations the class hierarchy was built from, sorted */
+    mutable std::vector<BaseClassRelation> class_hierarchy_classes;
+    mutable std::vector<BaseClassRelation> class_hierarchy_base_classes;
+
+    /** True if the registry has changed since the class hierarchy was updated */
+    mutable bool class_hierarchy_outdated;
+
+    /** The published snapshot, only accessed with boost::atomic_load and boost::atomic_store */
+    boost::shared_ptr<const RegistrySnapshot> snapshot;
+
+    /** Number of open batches of changes, see beginChanges */
+    unsigned change_batch_depth;
 
-    /** Mapping between base class name and corresponding classes */
-    std::multimap<std::string, PluginInfoPtr> base_classes_available;
+    /** parsePluginMetaInformation as plain function, see overridesMetaInformationCallback */
+    typedef void (*MetaInformationCallback)(PluginManager*, const PluginInfoPtr&, TiXmlElement*);
 
-    /** Mapping between class name without namespace and plugin information */
-    std::multimap<std::string, PluginInfoPtr> classes_no_ns_available;
+    /** The callback of this class, resolved while it is constructed */
+    MetaInformationCallback default_meta_callback;
 };
 
 }
\ No newline at end of file
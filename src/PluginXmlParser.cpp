@@ -0,0 +1,643 @@
+#include "PluginXmlParser.hpp"
+#include "TypeName.hpp"
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <glog/logging.h>
+
+using namespace plugin_manager;
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool startsWith(const char* pos, const char* end, const char* prefix)
+{
+    size_t size = strlen(prefix);
+    return (size_t)(end - pos) >= size && memcmp(pos, prefix, size) == 0;
+}
+
+static const char* find(const char* pos, const char* end, const char* str)
+{
+    const char* found = std::search(pos, end, str, str + strlen(str));
+    return found == end ? NULL : found;
+}
+
+static void appendUtf8(unsigned long code_point, std::string& out)
+{
+    if(code_point < 0x80)
+        out += (char)code_point;
+    else if(code_point < 0x800)
+    {
+        out += (char)(0xC0 | (code_point >> 6));
+        out += (char)(0x80 | (code_point & 0x3F));
+    }
+    else if(code_point < 0x10000)
+    {
+        out += (char)(0xE0 | (code_point >> 12));
+        out += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out += (char)(0x80 | (code_point & 0x3F));
+    }
+    else
+    {
+        out += (char)(0xF0 | (code_point >> 18));
+        out += (char)(0x80 | ((code_point >> 12) & 0x3F));
+        out += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out += (char)(0x80 | (code_point & 0x3F));
+    }
+}
+
+/** Decodes the entity at pos and returns the position after it, or pos if it isn't a known entity */
+static const char* decodeEntity(const char* pos, const char* end, std::string& out)
+{
+    const char* semicolon = std::find(pos, std::min(end, pos + 12), ';');
+    if(semicolon == std::min(end, pos + 12))
+        return pos;
+
+    std::string entity(pos + 1, semicolon);
+    if(entity == "amp")
+        out += '&';
+    else if(entity == "lt")
+        out += '<';
+    else if(entity == "gt")
+        out += '>';
+    else if(entity == "quot")
+        out += '"';
+    else if(entity == "apos")
+        out += '\'';
+    else if(entity.size() > 1 && entity[0] == '#')
+    {
+        char* number_end = NULL;
+        unsigned long code_point = (entity[1] == 'x' || entity[1] == 'X') ?
+                                   strtoul(entity.c_str() + 2, &number_end, 16) : strtoul(entity.c_str() + 1, &number_end, 10);
+        if(number_end == NULL || *number_end != '\0' || code_point > 0x10FFFF)
+            return pos;
+        appendUtf8(code_point, out);
+    }
+    else
+        return pos;
+    return semicolon + 1;
+}
+
+bool PluginXmlParser::Tag::is(const char* other) const
+{
+    return strlen(other) == name_size && memcmp(name, other, name_size) == 0;
+}
+
+const PluginXmlParser::Attribute* PluginXmlParser::Tag::attribute(const char* attribute_name) const
+{
+    size_t size = strlen(attribute_name);
+    for(const Attribute& attribute : attributes)
+    {
+        if(attribute.name_size == size && memcmp(attribute.name, attribute_name, size) == 0)
+            return &attribute;
+    }
+    return NULL;
+}
+
+PluginXmlParser::PluginXmlParser() : pos(NULL), end(NULL), tag_begin(NULL)
+{
+}
+
+bool PluginXmlParser::load(const std::string& xml_file)
+{
+    this->xml_file = xml_file;
+    content.clear();
+    error.clear();
+
+    std::ifstream file(xml_file.c_str(), std::ios::binary);
+    if(!file)
+    {
+        error = "Failed to open " + xml_file;
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    if(size < 0)
+    {
+        error = "Failed to read " + xml_file;
+        return false;
+    }
+    content.resize(size);
+    if(size > 0 && !file.read(&content[0], size))
+    {
+        error = "Failed to read " + xml_file;
+        return false;
+    }
+    return true;
+}
+
+const std::string& PluginXmlParser::getError() const
+{
+    return error;
+}
+
+bool PluginXmlParser::fail(const std::string& message)
+{
+    size_t line = 1 + std::count(content.data(), std::min(pos, end), '\n');
+    error = message + " in " + xml_file + " at line " + std::to_string(line);
+    return false;
+}
+
+void PluginXmlParser::skipMisc()
+{
+    while(pos < end)
+    {
+        if(isSpace(*pos))
+            pos++;
+        else if(startsWith(pos, end, "<?"))
+        {
+            const char* found = find(pos, end, "?>");
+            pos = found ? found + 2 : end;
+        }
+        else if(startsWith(pos, end, "<!--"))
+        {
+            const char* found = find(pos, end, "-->");
+            pos = found ? found + 3 : end;
+        }
+        else if(startsWith(pos, end, "<!"))
+        {
+            const char* found = std::find(pos, end, '>');
+            pos = found != end ? found + 1 : end;
+        }
+        else
+            break;
+    }
+}
+
+bool PluginXmlParser::readTag(Tag& tag)
+{
+    tag.attributes.clear();
+    tag.self_closing = false;
+    tag.end_tag = false;
+    tag_begin = pos;
+
+    pos++;
+    if(pos < end && *pos == '/')
+    {
+        tag.end_tag = true;
+        pos++;
+    }
+    tag.name = pos;
+    while(pos < end && !isSpace(*pos) && *pos != '/' && *pos != '>')
+        pos++;
+    tag.name_size = pos - tag.name;
+    if(tag.name_size == 0)
+        return fail("Invalid tag");
+
+    while(true)
+    {
+        while(pos < end && isSpace(*pos))
+            pos++;
+        if(pos >= end)
+            return fail("Unexpected end of file");
+        if(*pos == '>')
+        {
+            pos++;
+            return true;
+        }
+        if(*pos == '/' && pos + 1 < end && pos[1] == '>')
+        {
+            pos += 2;
+            tag.self_closing = !tag.end_tag;
+            return true;
+        }
+        if(tag.end_tag)
+            return fail("Invalid end tag");
+
+        Attribute attribute;
+        attribute.name = pos;
+        while(pos < end && !isSpace(*pos) && *pos != '=' && *pos != '/' && *pos != '>')
+            pos++;
+        attribute.name_size = pos - attribute.name;
+        while(pos < end && isSpace(*pos))
+            pos++;
+        if(attribute.name_size == 0 || pos >= end || *pos != '=')
+            return fail("Invalid attribute");
+        pos++;
+        while(pos < end && isSpace(*pos))
+            pos++;
+        if(pos >= end || (*pos != '"' && *pos != '\''))
+            return fail("Invalid attribute value");
+        const char quote = *pos++;
+        attribute.value = pos;
+        pos = std::find(pos, end, quote);
+        if(pos >= end)
+            return fail("Unterminated attribute value");
+        attribute.value_size = pos - attribute.value;
+        pos++;
+        tag.attributes.push_back(attribute);
+    }
+}
+
+bool PluginXmlParser::nextChild(Tag& tag)
+{
+    while(true)
+    {
+        pos = std::find(pos, end, '<');
+        if(pos >= end)
+            return fail("Missing end tag");
+
+        const char* found = NULL;
+        if(startsWith(pos, end, "<!--"))
+            found = find(pos, end, "-->");
+        else if(startsWith(pos, end, "<![CDATA["))
+            found = find(pos, end, "]]>");
+        else if(startsWith(pos, end, "<?"))
+            found = find(pos, end, "?>");
+        else
+        {
+            if(!readTag(tag))
+                return false;
+            // the end tag of the parent element
+            return !tag.end_tag;
+        }
+
+        if(found == NULL)
+            return fail("Unterminated section");
+        pos = found + (found[0] == '?' ? 2 : 3);
+    }
+}
+
+bool PluginXmlParser::skipElement(const Tag& tag)
+{
+    if(tag.self_closing)
+        return true;
+
+    Tag child;
+    while(nextChild(child))
+    {
+        if(!skipElement(child))
+            return false;
+    }
+    return error.empty();
+}
+
+bool PluginXmlParser::readText(const Tag& tag, std::string& text)
+{
+    text.clear();
+    if(tag.self_closing)
+        return true;
+    readLeadingText(text);
+    return skipElement(tag);
+}
+
+void PluginXmlParser::readLeadingText(std::string& text)
+{
+    // only the text before the first child node is used, like TiXmlElement::GetText does
+    const char* text_end = std::find(pos, end, '<');
+    decodeText(pos, text_end, text);
+    if(text.empty() && startsWith(text_end, end, "<![CDATA["))
+    {
+        const char* cdata_end = find(text_end, end, "]]>");
+        if(cdata_end != NULL)
+            text.assign(text_end + 9, cdata_end);
+    }
+    pos = text_end;
+}
+
+bool PluginXmlParser::parse(bool parse_details, std::vector< boost::shared_ptr<PluginInfo> >& classes,
+                            std::vector<std::string>& meta_elements, std::vector<BaseClassRelation>& base_classes)
+{
+    pos = content.data();
+    end = content.data() + content.size();
+    error.clear();
+
+    skipMisc();
+    if(pos >= end || *pos != '<')
+        return fail("Missing root element");
+
+    Tag tag;
+    if(!readTag(tag))
+        return false;
+    if(tag.end_tag || !tag.is("library"))
+        return fail("The root tag must be \"library\"");
+
+    // following top level elements are accepted as long as they are libraries
+    while(true)
+    {
+        if(tag.is("library"))
+        {
+            if(!parseLibrary(tag, parse_details, classes, meta_elements, base_classes))
+                return false;
+        }
+        else if(!skipElement(tag))
+            return false;
+
+        skipMisc();
+        if(pos >= end)
+            return true;
+        if(*pos != '<')
+            return fail("Unexpected content");
+        if(!readTag(tag))
+            return false;
+        if(tag.end_tag)
+            return fail("Unexpected end tag");
+    }
+}
+
+bool PluginXmlParser::parseLibrary(const Tag& library_tag, bool parse_details,
+                                   std::vector< boost::shared_ptr<PluginInfo> >& classes, std::vector<std::string>& meta_elements,
+                                   std::vector<BaseClassRelation>& base_classes)
+{
+    const Attribute* path = library_tag.attribute("path");
+    if(path == NULL)
+    {
+        LOG(ERROR) << "Failed to find path attirbute in library element in " << xml_file;
+        return skipElement(library_tag);
+    }
+    if(library_tag.self_closing)
+        return true;
+
+    std::string library_path;
+    decode(path->value, path->value + path->value_size, library_path);
+
+    Tag child;
+    while(nextChild(child))
+    {
+        if(child.is("base_class"))
+        {
+            // declares the base class of a type which isn't a plugin class itself
+            const Attribute* class_name = child.attribute("class_name");
+            const Attribute* base_class_name = child.attribute("base_class_name");
+            if(class_name != NULL && base_class_name != NULL)
+            {
+                base_classes.push_back(BaseClassRelation());
+                decodeTypeName(class_name->value, class_name->value + class_name->value_size, base_classes.back().first);
+                decodeTypeName(base_class_name->value, base_class_name->value + base_class_name->value_size, base_classes.back().second);
+            }
+            else
+                LOG(ERROR) << "Couldn't find a valid class_name or base_class_name attribute in base_class element in " << xml_file;
+            if(!skipElement(child))
+                return false;
+            continue;
+        }
+        if(!child.is("class"))
+        {
+            if(!skipElement(child))
+                return false;
+            continue;
+        }
+
+        boost::shared_ptr<PluginInfo> plugin_info(new PluginInfo);
+        std::string meta_element;
+        const Attribute* full_class_name = child.attribute("class_name");
+        const Attribute* base_class_name = child.attribute("base_class_name");
+        if(!parseClass(child, tag_begin - content.data(), parse_details, *plugin_info, meta_element))
+            return false;
+
+        if(full_class_name != NULL && base_class_name != NULL)
+        {
+            plugin_info->library_path = library_path;
+            plugin_info->xml_file = xml_file;
+            classes.push_back(plugin_info);
+            if(parse_details)
+                meta_elements.push_back(meta_element);
+        }
+        else
+        {
+            LOG(ERROR) << "Couldn't find a valid class_name or base_class_name attribute in class element in " << xml_file;
+        }
+    }
+    return error.empty();
+}
+
+bool PluginXmlParser::parseClass(const Tag& class_tag, size_t position, bool parse_details,
+                                 PluginInfo& plugin_info, std::string& meta_element)
+{
+    const Attribute* full_class_name = class_tag.attribute("class_name");
+    const Attribute* base_class_name = class_tag.attribute("base_class_name");
+    if(full_class_name != NULL)
+    {
+        decodeTypeName(full_class_name->value, full_class_name->value + full_class_name->value_size, plugin_info.full_class_name);
+        std::string xml_class_name;
+        decode(full_class_name->value, full_class_name->value + full_class_name->value_size, xml_class_name);
+        if(xml_class_name != plugin_info.full_class_name)
+            plugin_info.xml_class_name.swap(xml_class_name);
+    }
+    if(base_class_name != NULL)
+        decodeTypeName(base_class_name->value, base_class_name->value + base_class_name->value_size, plugin_info.base_class_name);
+    plugin_info.xml_position = position;
+    plugin_info.details_loaded = parse_details;
+    meta_element.clear();
+    if(class_tag.self_closing)
+        return true;
+
+    // only the first element of each kind is used
+    bool has_singleton = false;
+    bool has_description = false;
+    bool has_associations = false;
+    bool has_meta = false;
+    Tag child;
+    std::string text;
+    while(nextChild(child))
+    {
+        bool parsed = true;
+        if(child.is("singleton") && !has_singleton)
+        {
+            has_singleton = true;
+            parsed = readText(child, text);
+            plugin_info.singleton = text == "true";
+        }
+        else if(parse_details && child.is("description") && !has_description)
+        {
+            has_description = true;
+            parsed = readText(child, plugin_info.description);
+        }
+        else if(parse_details && child.is("associations") && !has_associations)
+        {
+            has_associations = true;
+            if(!child.self_closing)
+            {
+                Tag association;
+                while(nextChild(association))
+                {
+                    const Attribute* associated_class_name = association.attribute("class_name");
+                    if(association.is("class") && associated_class_name != NULL)
+                    {
+                        plugin_info.associated_classes.push_back(std::string());
+                        decodeTypeName(associated_class_name->value, associated_class_name->value + associated_class_name->value_size,
+                                       plugin_info.associated_classes.back());
+                    }
+                    if(!skipElement(association))
+                        return false;
+                }
+                parsed = error.empty();
+            }
+        }
+        else if(parse_details && child.is("meta") && !has_meta)
+        {
+            has_meta = true;
+            const char* meta_begin = tag_begin;
+            parsed = parseMeta(child, std::string(), plugin_info.meta_attributes);
+            meta_element.assign(meta_begin, pos);
+        }
+        else
+            parsed = skipElement(child);
+
+        if(!parsed)
+            return false;
+    }
+    return error.empty();
+}
+
+bool PluginXmlParser::parseClassDetails(PluginInfo& plugin_info, std::string& meta_element)
+{
+    pos = content.data();
+    end = content.data() + content.size();
+    error.clear();
+
+    // try the recorded position first
+    if(plugin_info.xml_position < content.size() && startsWith(pos + plugin_info.xml_position, end, "<class"))
+    {
+        pos += plugin_info.xml_position;
+        Tag tag;
+        PluginInfo details;
+        if(readTag(tag) && tag.is("class") && !tag.end_tag &&
+           parseClass(tag, plugin_info.xml_position, true, details, meta_element) &&
+           details.full_class_name == plugin_info.full_class_name)
+        {
+            plugin_info.description.swap(details.description);
+            plugin_info.associated_classes.swap(details.associated_classes);
+            plugin_info.meta_attributes.swap(details.meta_attributes);
+            plugin_info.details_loaded = true;
+            return true;
+        }
+    }
+
+    // the file has changed, search the class by name
+    std::vector< boost::shared_ptr<PluginInfo> > classes;
+    std::vector<std::string> meta_elements;
+    std::vector<BaseClassRelation> base_classes;
+    if(!parse(true, classes, meta_elements, base_classes))
+        return false;
+    for(size_t i = 0; i < classes.size(); i++)
+    {
+        if(classes[i]->full_class_name == plugin_info.full_class_name)
+        {
+            plugin_info.description.swap(classes[i]->description);
+            plugin_info.associated_classes.swap(classes[i]->associated_classes);
+            plugin_info.meta_attributes.swap(classes[i]->meta_attributes);
+            plugin_info.xml_position = classes[i]->xml_position;
+            plugin_info.details_loaded = true;
+            meta_element.swap(meta_elements[i]);
+            return true;
+        }
+    }
+    error = "Class " + plugin_info.full_class_name + " is no longer defined in " + xml_file;
+    return false;
+}
+
+bool PluginXmlParser::parseMetaElement(const std::string& meta_element, std::vector<MetaAttribute>& meta_attributes)
+{
+    xml_file = "meta element";
+    content = meta_element;
+    pos = content.data();
+    end = content.data() + content.size();
+    error.clear();
+
+    skipMisc();
+    if(pos >= end || *pos != '<')
+        return fail("Missing root element");
+    Tag tag;
+    if(!readTag(tag))
+        return false;
+    if(tag.end_tag)
+        return fail("Unexpected end tag");
+    return parseMeta(tag, std::string(), meta_attributes);
+}
+
+bool PluginXmlParser::parseMeta(const Tag& tag, const std::string& path, std::vector<MetaAttribute>& meta_attributes)
+{
+    if(tag.self_closing)
+        return true;
+
+    Tag child;
+    std::string text;
+    while(nextChild(child))
+    {
+        std::string child_path(path);
+        if(!child_path.empty())
+            child_path += '.';
+        child_path.append(child.name, child.name_size);
+        for(const Attribute& attribute : child.attributes)
+        {
+            meta_attributes.push_back(MetaAttribute(child_path + "." + std::string(attribute.name, attribute.name_size), std::string()));
+            decode(attribute.value, attribute.value + attribute.value_size, meta_attributes.back().second);
+        }
+
+        if(!child.self_closing)
+        {
+            text.clear();
+            readLeadingText(text);
+            if(!text.empty())
+                meta_attributes.push_back(MetaAttribute(child_path, text));
+        }
+
+        if(!parseMeta(child, child_path, meta_attributes))
+            return false;
+    }
+    return error.empty();
+}
+
+void PluginXmlParser::decode(const char* begin, const char* end, std::string& out)
+{
+    out.reserve(out.size() + (end - begin));
+    for(const char* c = begin; c < end; )
+    {
+        if(*c == '&')
+        {
+            const char* next = decodeEntity(c, end, out);
+            if(next != c)
+            {
+                c = next;
+                continue;
+            }
+        }
+        out += *c++;
+    }
+}
+
+void PluginXmlParser::decodeTypeName(const char* begin, const char* end, std::string& out)
+{
+    const size_t name_begin = out.size();
+    decode(begin, end, out);
+    TypeName type_name(boost::string_view(out).substr(name_begin));
+    if(type_name.isCanonical())
+        return;
+    std::string canonical_name;
+    type_name.appendCanonical(canonical_name);
+    out.replace(name_begin, std::string::npos, canonical_name);
+}
+
+void PluginXmlParser::decodeText(const char* begin, const char* end, std::string& out)
+{
+    bool pending_space = false;
+    for(const char* c = begin; c < end; )
+    {
+        if(isSpace(*c))
+        {
+            pending_space = !out.empty();
+            c++;
+            continue;
+        }
+        if(pending_space)
+        {
+            out += ' ';
+            pending_space = false;
+        }
+        if(*c == '&')
+        {
+            const char* next = decodeEntity(c, end, out);
+            if(next != c)
+            {
+                c = next;
+                continue;
+            }
+        }
+        out += *c++;
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <boost/shared_ptr.hpp>
+#include "PluginInfo.hpp"
+#include "XMLPluginFile.hpp"
+
+namespace plugin_manager
+{
+
+/**
+ * @class PluginXmlParser
+ * @brief A streaming parser for xml plugin files.
+ * The parser reads the library, class, base_class, description, associations, singleton and meta
+ * elements in a single pass over the file content and writes them directly into PluginInfo
+ * instances, no document tree is created. Unknown elements are skipped.
+ * Meta elements are returned as raw xml strings, since their content is user specific,
+ * and their attributes and texts are added to the meta attributes of the plugin info.
+ * Text content is normalized like TinyXML does it, i.e. entities are decoded, leading and
+ * trailing white space is removed and white space sequences are condensed to a single space.
+ */
+class PluginXmlParser
+{
+public:
+    PluginXmlParser();
+
+    /**
+     * @brief Reads the content of the given xml file
+     * @param xml_file path to the xml file
+     * @return True if the file could be read
+     */
+    bool load(const std::string& xml_file);
+
+    /**
+     * @brief Parses all class elements of the loaded file.
+     * The class name without namespace is not set by the parser.
+     * The position of each plugin info is set to the offset of its class element.
+     * @param parse_details if false the description, the associations and the meta elements are skipped
+     *                      and the details of the plugin infos are marked as not loaded
+     * @param classes the plugin infos found
+     * @param meta_elements the meta element of each class, an empty string if the class has none.
+     *                      This stays empty if the details are not parsed.
+     * @param base_classes the base class relations declared by base_class elements
+     * @return True if the file was successfully parsed
+     */
+    bool parse(bool parse_details, std::vector< boost::shared_ptr<PluginInfo> >& classes,
+               std::vector<std::string>& meta_elements, std::vector<BaseClassRelation>& base_classes);
+
+    /**
+     * @brief Parses the description, the associations and the meta element of a single class.
+     * The class element is expected at the position recorded in the plugin info,
+     * if it isn't found there the file is searched for the class name.
+     * @param plugin_info the plugin info to fill
+     * @param meta_element the meta element of the class, empty if it has none
+     * @return True if the class element was found
+     */
+    bool parseClassDetails(PluginInfo& plugin_info, std::string& meta_element);
+
+    /**
+     * @brief Parses a meta element which was returned by parse, e.g. after it was read from the registry cache.
+     * The content of a loaded file is replaced.
+     * @param meta_element the meta element as xml string
+     * @param meta_attributes the attributes and texts of the child elements are added to it, see PluginInfo::meta_attributes
+     * @return True if the meta element was successfully parsed
+     */
+    bool parseMetaElement(const std::string& meta_element, std::vector<MetaAttribute>& meta_attributes);
+
+    /**
+     * @brief Returns a description of the last error
+     */
+    const std::string& getError() const;
+
+private:
+    struct Attribute
+    {
+        const char* name;
+        size_t name_size;
+        const char* value;
+        size_t value_size;
+    };
+
+    struct Tag
+    {
+        const char* name;
+        size_t name_size;
+        bool self_closing;
+        bool end_tag;
+        std::vector<Attribute> attributes;
+
+        bool is(const char* other) const;
+        const Attribute* attribute(const char* attribute_name) const;
+    };
+
+    /** Skips white space, comments, processing instructions and doctype declarations */
+    void skipMisc();
+
+    /** Reads the next start or end tag, the current position must be at a '<' */
+    bool readTag(Tag& tag);
+
+    /** Skips the content and the end tag of an element whose start tag has been read */
+    bool skipElement(const Tag& tag);
+
+    /** Reads the text of an element up to the first child element and skips the rest of the element */
+    bool readText(const Tag& tag, std::string& text);
+
+    /** Reads the text at the current position up to the next child node, the position is moved behind it */
+    void readLeadingText(std::string& text);
+
+    /** Reads the next child node of an element, returns false at its end tag */
+    bool nextChild(Tag& tag);
+
+    bool parseLibrary(const Tag& library_tag, bool parse_details,
+                      std::vector< boost::shared_ptr<PluginInfo> >& classes, std::vector<std::string>& meta_elements,
+                      std::vector<BaseClassRelation>& base_classes);
+
+    bool parseClass(const Tag& class_tag, size_t position, bool parse_details,
+                    PluginInfo& plugin_info, std::string& meta_element);
+
+    /** Adds the attributes and texts of the child elements of a meta element, the path is the key prefix of the element */
+    bool parseMeta(const Tag& tag, const std::string& path, std::vector<MetaAttribute>& meta_attributes);
+
+    /** Appends the decoded value to the string */
+    static void decode(const char* begin, const char* end, std::string& out);
+
+    /** Decodes a type name and brings it into canonical form, see TypeName */
+    static void decodeTypeName(const char* begin, const char* end, std::string& out);
+
+    /** Decodes and condenses text content */
+    static void decodeText(const char* begin, const char* end, std::string& out);
+
+    bool fail(const std::string& message);
+
+    std::string xml_file;
+    std::string content;
+    const char* pos;
+    const char* end;
+    /** Start of the last tag that was read */
+    const char* tag_begin;
+    std::string error;
+};
+
+}
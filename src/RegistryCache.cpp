@@ -0,0 +1,902 @@
+#include "RegistryCache.hpp"
+#include <map>
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <boost/filesystem.hpp>
+#include <glog/logging.h>
+
+using namespace plugin_manager;
+
+namespace
+{
+
+const char cache_magic[4] = {'P', 'M', 'R', 'C'};
+const uint32_t cache_version = 8;
+
+enum CacheFileFlags
+{
+    PARSE_FAILED = 1
+};
+
+enum CacheClassFlags
+{
+    SINGLETON = 1,
+    DETAILS_LOADED = 2,
+    AVAILABLE = 4
+};
+const uint32_t cache_byte_order = 0x01020304;
+
+/** Reference to a string in the string section */
+struct CacheString
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+/** The cache file starts with the header, followed by the file, class, association and
+ *  base class sections, the three class indexes, the association and meta attribute indexes
+ *  and the string section. */
+struct CacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t file_count;
+    uint32_t class_count;
+    uint32_t association_count;
+    uint32_t available_class_count;
+    uint32_t base_class_count;
+    uint32_t association_index_count;
+    uint32_t undetailed_class_count;
+    uint32_t meta_attribute_count;
+    uint32_t reserved;
+    uint64_t string_data_size;
+};
+
+struct CacheFile
+{
+    CacheString path;
+    uint32_t first_class;
+    uint32_t class_count;
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint64_t inode;
+    uint64_t device;
+    uint32_t flags;
+    uint32_t reserved;
+    uint32_t first_base_class;
+    uint32_t base_class_count;
+};
+
+struct CacheClass
+{
+    CacheString class_name;
+    CacheString full_class_name;
+    CacheString xml_class_name;
+    CacheString base_class_name;
+    CacheString library_path;
+    CacheString description;
+    CacheString meta_element;
+    uint32_t first_association;
+    uint32_t association_count;
+    uint32_t flags;
+    uint32_t xml_position;
+    uint32_t file;
+};
+
+/** A declared base class relation */
+struct CacheBaseClass
+{
+    CacheString class_name;
+    CacheString base_class_name;
+};
+
+/** Entry of the association index, the entries are sorted by associated class,
+ *  base class and full class name */
+struct CacheAssociation
+{
+    CacheString associated_class;
+    uint32_t class_index;
+};
+
+/** Entry of the meta attribute index, the entries are sorted by key, value and full class name */
+struct CacheMetaAttribute
+{
+    CacheString key;
+    CacheString value;
+    uint32_t class_index;
+};
+
+/** Collects the string section, equal strings are stored only once */
+class StringSection
+{
+public:
+    CacheString add(const std::string& str)
+    {
+        std::map<std::string, CacheString>::const_iterator it = strings.find(str);
+        if(it != strings.end())
+            return it->second;
+        CacheString cache_str;
+        cache_str.offset = data.size();
+        cache_str.size = str.size();
+        data += str;
+        strings.insert(std::make_pair(str, cache_str));
+        return cache_str;
+    }
+    std::string data;
+private:
+    std::map<std::string, CacheString> strings;
+};
+
+template<class T>
+void appendSection(std::string& image, const std::vector<T>& section)
+{
+    if(!section.empty())
+        image.append(reinterpret_cast<const char*>(&section.front()), section.size() * sizeof(T));
+}
+
+/** Gives access to the sections of a validated image, all string references are checked,
+ *  a damaged cache must not crash the process */
+struct CacheView
+{
+    const CacheHeader* header;
+    const CacheFile* files;
+    const CacheClass* classes;
+    const CacheString* associations;
+    const CacheBaseClass* base_classes;
+    const uint32_t* full_class_name_index;
+    const uint32_t* class_name_index;
+    const uint32_t* base_class_index;
+    const CacheAssociation* association_index;
+    const CacheMetaAttribute* meta_attribute_index;
+    const char* strings;
+
+    explicit CacheView(const char* data)
+    {
+        header = reinterpret_cast<const CacheHeader*>(data);
+        files = reinterpret_cast<const CacheFile*>(data + sizeof(CacheHeader));
+        classes = reinterpret_cast<const CacheClass*>(files + header->file_count);
+        associations = reinterpret_cast<const CacheString*>(classes + header->class_count);
+        base_classes = reinterpret_cast<const CacheBaseClass*>(associations + header->association_count);
+        full_class_name_index = reinterpret_cast<const uint32_t*>(base_classes + header->base_class_count);
+        class_name_index = full_class_name_index + header->available_class_count;
+        base_class_index = class_name_index + header->available_class_count;
+        association_index = reinterpret_cast<const CacheAssociation*>(base_class_index + header->available_class_count);
+        meta_attribute_index = reinterpret_cast<const CacheMetaAttribute*>(association_index + header->association_index_count);
+        strings = reinterpret_cast<const char*>(meta_attribute_index + header->meta_attribute_count);
+    }
+
+    bool read(const CacheString& str, std::string& out) const
+    {
+        if((uint64_t)str.offset + str.size > header->string_data_size)
+            return false;
+        out.assign(strings + str.offset, str.size);
+        return true;
+    }
+
+    int compare(const CacheString& str, boost::string_view other) const
+    {
+        if((uint64_t)str.offset + str.size > header->string_data_size)
+            return -1;
+        return boost::string_view(strings + str.offset, str.size).compare(other);
+    }
+
+    bool startsWith(const CacheString& str, boost::string_view prefix) const
+    {
+        if((uint64_t)str.offset + str.size > header->string_data_size)
+            return false;
+        return boost::string_view(strings + str.offset, str.size).starts_with(prefix);
+    }
+
+    /** Returns the range of an index whose entries have the given value in the given field */
+    std::pair<const uint32_t*, const uint32_t*> equalRange(const uint32_t* index, CacheString CacheClass::*field,
+                                                            boost::string_view value) const
+    {
+        const uint32_t* index_end = index + header->available_class_count;
+        const CacheClass* class_records = classes;
+        const CacheView* view = this;
+        const uint32_t* begin = std::lower_bound(index, index_end, value,
+                                                 [&](uint32_t i, boost::string_view v) { return view->compare(class_records[i].*field, v) < 0; });
+        const uint32_t* end = std::upper_bound(begin, index_end, value,
+                                               [&](boost::string_view v, uint32_t i) { return view->compare(class_records[i].*field, v) > 0; });
+        return std::make_pair(begin, end);
+    }
+};
+
+}
+
+RegistryCache::RegistryCache() : data(NULL), data_size(0)
+{
+}
+
+RegistryCache::~RegistryCache()
+{
+    close();
+}
+
+bool RegistryCache::open(const std::string& cache_file)
+{
+    close();
+
+    int fd = ::open(cache_file.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+    return map(fd, cache_file, false);
+}
+
+bool RegistryCache::openSharedMemory(const std::string& segment_name)
+{
+    close();
+
+    int fd = shm_open(segment_name.c_str(), O_RDONLY, 0);
+    if(fd < 0)
+        return false;
+    return map(fd, segment_name, true);
+}
+
+bool RegistryCache::map(int fd, const std::string& name, bool check_owner)
+{
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0 || file_stat.st_size < (off_t)sizeof(CacheHeader))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // the registry names the libraries which are loaded later, a segment that
+    // could have been created or modified by another user must not be used
+    if(check_owner && (file_stat.st_uid != geteuid() || (file_stat.st_mode & (S_IWGRP | S_IWOTH)) != 0))
+    {
+        LOG(WARNING) << "Ignoring shared registry " << name << ", it isn't owned by this user or is writable by others";
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(NULL, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED)
+        return false;
+
+    data = static_cast<const char*>(mapping);
+    data_size = file_stat.st_size;
+    if(!validate())
+    {
+        LOG(WARNING) << "Ignoring invalid registry cache " << name;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void RegistryCache::close()
+{
+    if(data != NULL)
+        munmap(const_cast<char*>(data), data_size);
+    data = NULL;
+    data_size = 0;
+}
+
+bool RegistryCache::isOpen() const
+{
+    return data != NULL;
+}
+
+size_t RegistryCache::getFileCount() const
+{
+    if(data == NULL)
+        return 0;
+    return reinterpret_cast<const CacheHeader*>(data)->file_count;
+}
+
+size_t RegistryCache::getClassCount() const
+{
+    if(data == NULL)
+        return 0;
+    return reinterpret_cast<const CacheHeader*>(data)->class_count;
+}
+
+bool RegistryCache::validate() const
+{
+    // the magic is written last when a shared memory segment is created
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(data);
+    if(memcmp(header->magic, cache_magic, sizeof(cache_magic)) != 0)
+        return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(header->version != cache_version || header->byte_order != cache_byte_order ||
+       header->available_class_count > header->class_count)
+        return false;
+
+    uint64_t expected_size = sizeof(CacheHeader) + (uint64_t)header->file_count * sizeof(CacheFile) +
+                             (uint64_t)header->class_count * sizeof(CacheClass) +
+                             (uint64_t)header->association_count * sizeof(CacheString) +
+                             (uint64_t)header->base_class_count * sizeof(CacheBaseClass) +
+                             (uint64_t)header->available_class_count * 3 * sizeof(uint32_t) +
+                             (uint64_t)header->association_index_count * sizeof(CacheAssociation) +
+                             (uint64_t)header->meta_attribute_count * sizeof(CacheMetaAttribute) + header->string_data_size;
+    if(expected_size != data_size)
+        return false;
+
+    // the indexes are used without further checks
+    CacheView view(data);
+    for(uint32_t i = 0; i < header->available_class_count * 3; i++)
+    {
+        if(view.full_class_name_index[i] >= header->class_count)
+            return false;
+    }
+    for(uint32_t i = 0; i < header->association_index_count; i++)
+    {
+        if(view.association_index[i].class_index >= header->class_count)
+            return false;
+    }
+    for(uint32_t i = 0; i < header->meta_attribute_count; i++)
+    {
+        if(view.meta_attribute_index[i].class_index >= header->class_count)
+            return false;
+    }
+    return true;
+}
+
+bool RegistryCache::lookup(const FileFingerprint& fingerprint, XMLPluginFile& plugin_file) const
+{
+    if(data == NULL)
+        return false;
+    CacheView view(data);
+
+    // files are sorted by path
+    const CacheFile* files_end = view.files + view.header->file_count;
+    const CacheFile* file = std::lower_bound(view.files, files_end, plugin_file.path,
+                                             [&view](const CacheFile& f, const std::string& path) { return view.compare(f.path, path) < 0; });
+    if(file == files_end || view.compare(file->path, plugin_file.path) != 0 || (file->flags & PARSE_FAILED) ||
+       file->size != fingerprint.size || file->mtime_sec != fingerprint.mtime_sec || file->mtime_nsec != fingerprint.mtime_nsec ||
+       file->inode != fingerprint.inode || file->device != fingerprint.device)
+        return false;
+
+    std::string path = plugin_file.path;
+    if(!getFile(file - view.files, plugin_file))
+        return false;
+    plugin_file.path = path;
+    return true;
+}
+
+bool RegistryCache::getFileInfo(size_t index, XMLPluginFile& plugin_file) const
+{
+    if(data == NULL || index >= getFileCount())
+        return false;
+    CacheView view(data);
+
+    const CacheFile* file = view.files + index;
+    if(!view.read(file->path, plugin_file.path))
+        return false;
+    plugin_file.fingerprint.size = file->size;
+    plugin_file.fingerprint.mtime_sec = file->mtime_sec;
+    plugin_file.fingerprint.mtime_nsec = file->mtime_nsec;
+    plugin_file.fingerprint.inode = file->inode;
+    plugin_file.fingerprint.device = file->device;
+    plugin_file.parse_failed = (file->flags & PARSE_FAILED) != 0;
+    return true;
+}
+
+bool RegistryCache::getFile(size_t index, XMLPluginFile& plugin_file) const
+{
+    if(data == NULL || index >= getFileCount())
+        return false;
+    CacheView view(data);
+
+    const CacheFile* file = view.files + index;
+    if((uint64_t)file->first_class + file->class_count > view.header->class_count ||
+       (uint64_t)file->first_base_class + file->base_class_count > view.header->base_class_count)
+        return false;
+
+    std::vector< boost::shared_ptr<PluginInfo> > cached_classes;
+    std::vector<std::string> meta_elements;
+    for(uint32_t class_index = file->first_class; class_index < file->first_class + file->class_count; class_index++)
+    {
+        boost::shared_ptr<PluginInfo> plugin_info(new PluginInfo);
+        std::string meta_element;
+        if(!readClass(class_index, *plugin_info) || !view.read(view.classes[class_index].meta_element, meta_element))
+            return false;
+        cached_classes.push_back(plugin_info);
+        meta_elements.push_back(meta_element);
+    }
+
+    std::vector<BaseClassRelation> base_classes(file->base_class_count);
+    for(uint32_t i = 0; i < file->base_class_count; i++)
+    {
+        const CacheBaseClass& base_class = view.base_classes[file->first_base_class + i];
+        if(!view.read(base_class.class_name, base_classes[i].first) || !view.read(base_class.base_class_name, base_classes[i].second))
+            return false;
+    }
+
+    if(!getFileInfo(index, plugin_file))
+        return false;
+    plugin_file.classes.swap(cached_classes);
+    plugin_file.meta_elements.swap(meta_elements);
+    plugin_file.base_classes.swap(base_classes);
+    return true;
+}
+
+bool RegistryCache::findClass(boost::string_view full_class_name, uint32_t& class_index) const
+{
+    if(data == NULL)
+        return false;
+    CacheView view(data);
+    std::pair<const uint32_t*, const uint32_t*> range = view.equalRange(view.full_class_name_index, &CacheClass::full_class_name, full_class_name);
+    if(range.first == range.second)
+        return false;
+    class_index = *range.first;
+    return true;
+}
+
+size_t RegistryCache::findClassesWithoutNamespace(boost::string_view class_name, uint32_t& class_index) const
+{
+    if(data == NULL)
+        return 0;
+    CacheView view(data);
+    std::pair<const uint32_t*, const uint32_t*> range = view.equalRange(view.class_name_index, &CacheClass::class_name, class_name);
+    if(range.first != range.second)
+        class_index = *range.first;
+    return range.second - range.first;
+}
+
+void RegistryCache::getAvailableClasses(std::vector<std::string>& classes) const
+{
+    if(data == NULL)
+        return;
+    CacheView view(data);
+    classes.reserve(classes.size() + view.header->available_class_count);
+    for(uint32_t i = 0; i < view.header->available_class_count; i++)
+    {
+        classes.push_back(std::string());
+        view.read(view.classes[view.full_class_name_index[i]].full_class_name, classes.back());
+    }
+}
+
+void RegistryCache::getAvailableClasses(const std::string& base_class, std::vector<std::string>& classes) const
+{
+    if(data == NULL)
+        return;
+    CacheView view(data);
+    std::pair<const uint32_t*, const uint32_t*> range = view.equalRange(view.base_class_index, &CacheClass::base_class_name, base_class);
+    classes.reserve(classes.size() + (range.second - range.first));
+    for(const uint32_t* it = range.first; it != range.second; it++)
+    {
+        classes.push_back(std::string());
+        view.read(view.classes[*it].full_class_name, classes.back());
+    }
+}
+
+void RegistryCache::getClassesWithPrefix(boost::string_view prefix, boost::string_view base_class,
+                                         std::vector<std::string>& classes) const
+{
+    if(data == NULL)
+        return;
+    CacheView view(data);
+    const uint32_t* index_end = view.full_class_name_index + view.header->available_class_count;
+    const uint32_t* it = std::lower_bound(view.full_class_name_index, index_end, prefix,
+                                          [&view](uint32_t i, boost::string_view v) { return view.compare(view.classes[i].full_class_name, v) < 0; });
+    for(; it != index_end && view.startsWith(view.classes[*it].full_class_name, prefix); it++)
+    {
+        if(!base_class.empty() && view.compare(view.classes[*it].base_class_name, base_class) != 0)
+            continue;
+        classes.push_back(std::string());
+        view.read(view.classes[*it].full_class_name, classes.back());
+    }
+}
+
+bool RegistryCache::hasAvailableClassDetails() const
+{
+    return data != NULL && reinterpret_cast<const CacheHeader*>(data)->undetailed_class_count == 0;
+}
+
+void RegistryCache::getAssociatedClassesOfType(boost::string_view embedded_type, boost::string_view base_class,
+                                              std::vector<std::string>& classes) const
+{
+    if(data == NULL)
+        return;
+    CacheView view(data);
+
+    // the entries are sorted by associated class and base class
+    typedef std::pair<boost::string_view, boost::string_view> AssociationKey;
+    auto compareKey = [&view](const CacheAssociation& entry, const AssociationKey& key)
+    {
+        int result = view.compare(entry.associated_class, key.first);
+        if(result != 0)
+            return result;
+        return view.compare(view.classes[entry.class_index].base_class_name, key.second);
+    };
+    const AssociationKey key(embedded_type, base_class);
+    const CacheAssociation* index_end = view.association_index + view.header->association_index_count;
+    const CacheAssociation* it = std::lower_bound(view.association_index, index_end, key,
+                                                  [&](const CacheAssociation& entry, const AssociationKey& k) { return compareKey(entry, k) < 0; });
+    for(; it != index_end && compareKey(*it, key) == 0; it++)
+    {
+        classes.push_back(std::string());
+        view.read(view.classes[it->class_index].full_class_name, classes.back());
+    }
+}
+
+void RegistryCache::getClassesWithMeta(boost::string_view key, boost::string_view value, boost::string_view base_class,
+                                      std::vector<std::string>& classes) const
+{
+    if(data == NULL)
+        return;
+    CacheView view(data);
+
+    typedef std::pair<boost::string_view, boost::string_view> MetaKey;
+    auto compareKey = [&view](const CacheMetaAttribute& entry, const MetaKey& key)
+    {
+        int result = view.compare(entry.key, key.first);
+        if(result != 0)
+            return result;
+        return view.compare(entry.value, key.second);
+    };
+    const MetaKey meta_key(key, value);
+    const CacheMetaAttribute* index_end = view.meta_attribute_index + view.header->meta_attribute_count;
+    const CacheMetaAttribute* it = std::lower_bound(view.meta_attribute_index, index_end, meta_key,
+                                                    [&](const CacheMetaAttribute& entry, const MetaKey& k) { return compareKey(entry, k) < 0; });
+    for(; it != index_end && compareKey(*it, meta_key) == 0; it++)
+    {
+        const CacheClass& cached_class = view.classes[it->class_index];
+        if(!base_class.empty() && view.compare(cached_class.base_class_name, base_class) != 0)
+            continue;
+        classes.push_back(std::string());
+        view.read(cached_class.full_class_name, classes.back());
+    }
+}
+
+void RegistryCache::getAvailableClassIndexes(std::vector<uint32_t>& class_indexes) const
+{
+    if(data == NULL)
+        return;
+    CacheView view(data);
+    class_indexes.assign(view.full_class_name_index, view.full_class_name_index + view.header->available_class_count);
+}
+
+void RegistryCache::getBaseClasses(std::vector<BaseClassRelation>& base_classes) const
+{
+    if(data == NULL)
+        return;
+    CacheView view(data);
+    base_classes.reserve(base_classes.size() + view.header->base_class_count);
+    for(uint32_t i = 0; i < view.header->base_class_count; i++)
+    {
+        base_classes.push_back(BaseClassRelation());
+        view.read(view.base_classes[i].class_name, base_classes.back().first);
+        view.read(view.base_classes[i].base_class_name, base_classes.back().second);
+    }
+}
+
+std::string RegistryCache::getClassField(uint32_t class_index, ClassField field) const
+{
+    std::string value;
+    if(data == NULL || class_index >= reinterpret_cast<const CacheHeader*>(data)->class_count)
+        return value;
+    CacheView view(data);
+    const CacheClass& cached_class = view.classes[class_index];
+    switch(field)
+    {
+        case CLASS_NAME: view.read(cached_class.class_name, value); break;
+        case FULL_CLASS_NAME: view.read(cached_class.full_class_name, value); break;
+        case BASE_CLASS_NAME: view.read(cached_class.base_class_name, value); break;
+        case LIBRARY_PATH: view.read(cached_class.library_path, value); break;
+        case DESCRIPTION: view.read(cached_class.description, value); break;
+        case META_ELEMENT: view.read(cached_class.meta_element, value); break;
+        case XML_FILE:
+            if(cached_class.file < view.header->file_count)
+                view.read(view.files[cached_class.file].path, value);
+            break;
+    }
+    return value;
+}
+
+bool RegistryCache::isSingleton(uint32_t class_index) const
+{
+    if(data == NULL || class_index >= reinterpret_cast<const CacheHeader*>(data)->class_count)
+        return false;
+    return (CacheView(data).classes[class_index].flags & SINGLETON) != 0;
+}
+
+bool RegistryCache::hasClassDetails(uint32_t class_index) const
+{
+    if(data == NULL || class_index >= reinterpret_cast<const CacheHeader*>(data)->class_count)
+        return false;
+    return (CacheView(data).classes[class_index].flags & DETAILS_LOADED) != 0;
+}
+
+void RegistryCache::getAssociatedClasses(uint32_t class_index, std::vector<std::string>& associated_classes) const
+{
+    associated_classes.clear();
+    if(data == NULL || class_index >= reinterpret_cast<const CacheHeader*>(data)->class_count)
+        return;
+    CacheView view(data);
+    const CacheClass& cached_class = view.classes[class_index];
+    if((uint64_t)cached_class.first_association + cached_class.association_count > view.header->association_count)
+        return;
+    associated_classes.resize(cached_class.association_count);
+    for(uint32_t i = 0; i < cached_class.association_count; i++)
+        view.read(view.associations[cached_class.first_association + i], associated_classes[i]);
+}
+
+bool RegistryCache::readClass(uint32_t class_index, PluginInfo& plugin_info) const
+{
+    if(data == NULL || class_index >= reinterpret_cast<const CacheHeader*>(data)->class_count)
+        return false;
+    CacheView view(data);
+    const CacheClass& cached_class = view.classes[class_index];
+    if(!view.read(cached_class.class_name, plugin_info.class_name) ||
+        !view.read(cached_class.full_class_name, plugin_info.full_class_name) ||
+        !view.read(cached_class.xml_class_name, plugin_info.xml_class_name) ||
+        !view.read(cached_class.base_class_name, plugin_info.base_class_name) ||
+        !view.read(cached_class.library_path, plugin_info.library_path) ||
+        !view.read(cached_class.description, plugin_info.description) ||
+        cached_class.file >= view.header->file_count ||
+        !view.read(view.files[cached_class.file].path, plugin_info.xml_file) ||
+        (uint64_t)cached_class.first_association + cached_class.association_count > view.header->association_count)
+        return false;
+
+    plugin_info.singleton = (cached_class.flags & SINGLETON) != 0;
+    plugin_info.details_loaded = (cached_class.flags & DETAILS_LOADED) != 0;
+    plugin_info.xml_position = cached_class.xml_position;
+    getAssociatedClasses(class_index, plugin_info.associated_classes);
+    return true;
+}
+
+std::string RegistryCache::serialize(const std::vector<const XMLPluginFile*>& plugin_files)
+{
+    std::vector<const XMLPluginFile*> sorted_files;
+    for(const XMLPluginFile* plugin_file : plugin_files)
+    {
+        if(plugin_file->fingerprint.isValid())
+            sorted_files.push_back(plugin_file);
+    }
+    std::sort(sorted_files.begin(), sorted_files.end(),
+              [](const XMLPluginFile* a, const XMLPluginFile* b) { return a->path < b->path; });
+
+    StringSection strings;
+    std::vector<CacheFile> files;
+    std::vector<CacheClass> classes;
+    std::vector<CacheString> associations;
+    std::vector<CacheBaseClass> base_classes;
+    std::vector<uint32_t> available_classes;
+    std::vector<CacheAssociation> association_index;
+    std::vector<CacheMetaAttribute> meta_attribute_index;
+    uint32_t undetailed_class_count = 0;
+    std::set<std::string> available_class_names;
+    files.reserve(sorted_files.size());
+    for(const XMLPluginFile* plugin_file : sorted_files)
+    {
+        CacheFile file;
+        file.path = strings.add(plugin_file->path);
+        file.first_class = classes.size();
+        file.class_count = plugin_file->classes.size();
+        file.size = plugin_file->fingerprint.size;
+        file.mtime_sec = plugin_file->fingerprint.mtime_sec;
+        file.mtime_nsec = plugin_file->fingerprint.mtime_nsec;
+        file.inode = plugin_file->fingerprint.inode;
+        file.device = plugin_file->fingerprint.device;
+        file.flags = plugin_file->parse_failed ? PARSE_FAILED : 0;
+        file.reserved = 0;
+        file.first_base_class = base_classes.size();
+        file.base_class_count = plugin_file->base_classes.size();
+        files.push_back(file);
+        for(const BaseClassRelation& relation : plugin_file->base_classes)
+        {
+            CacheBaseClass base_class;
+            base_class.class_name = strings.add(relation.first);
+            base_class.base_class_name = strings.add(relation.second);
+            base_classes.push_back(base_class);
+        }
+
+        // the details can only be restored if the meta elements have been serialized
+        const bool has_meta_elements = plugin_file->meta_elements.size() == plugin_file->classes.size();
+        for(size_t i = 0; i < plugin_file->classes.size(); i++)
+        {
+            const PluginInfo& plugin_info = *plugin_file->classes[i];
+            CacheClass cached_class;
+            cached_class.class_name = strings.add(plugin_info.class_name);
+            cached_class.full_class_name = strings.add(plugin_info.full_class_name);
+            cached_class.xml_class_name = strings.add(plugin_info.xml_class_name);
+            cached_class.base_class_name = strings.add(plugin_info.base_class_name);
+            cached_class.library_path = strings.add(plugin_info.library_path);
+            cached_class.description = strings.add(plugin_info.description);
+            cached_class.meta_element = strings.add(has_meta_elements ? plugin_file->meta_elements[i] : std::string());
+            cached_class.first_association = associations.size();
+            cached_class.association_count = plugin_info.associated_classes.size();
+            cached_class.flags = (plugin_info.singleton ? SINGLETON : 0) | (plugin_info.details_loaded && has_meta_elements ? DETAILS_LOADED : 0);
+            cached_class.xml_position = plugin_info.xml_position;
+            cached_class.file = files.size() - 1;
+            for(const std::string& associated_class : plugin_info.associated_classes)
+                associations.push_back(strings.add(associated_class));
+
+            // like in the plugin manager the first definition in sorted file order is available
+            if(available_class_names.insert(plugin_info.full_class_name).second)
+            {
+                cached_class.flags |= AVAILABLE;
+                available_classes.push_back(classes.size());
+                if(cached_class.flags & DETAILS_LOADED)
+                {
+                    for(uint32_t j = 0; j < cached_class.association_count; j++)
+                    {
+                        CacheAssociation entry;
+                        entry.associated_class = associations[cached_class.first_association + j];
+                        entry.class_index = classes.size();
+                        association_index.push_back(entry);
+                    }
+                    for(const MetaAttribute& meta_attribute : plugin_info.meta_attributes)
+                    {
+                        CacheMetaAttribute entry;
+                        entry.key = strings.add(meta_attribute.first);
+                        entry.value = strings.add(meta_attribute.second);
+                        entry.class_index = classes.size();
+                        meta_attribute_index.push_back(entry);
+                    }
+                }
+                else
+                    undetailed_class_count++;
+            }
+            classes.push_back(cached_class);
+        }
+    }
+
+    // the indexes are sorted by their key, equal keys by the full class name
+    std::vector<uint32_t> full_class_name_index(available_classes);
+    std::vector<uint32_t> class_name_index(available_classes);
+    std::vector<uint32_t> base_class_index(available_classes);
+    auto sortIndex = [&](std::vector<uint32_t>& index, CacheString CacheClass::*field)
+    {
+        std::stable_sort(index.begin(), index.end(), [&](uint32_t a, uint32_t b)
+        {
+            const CacheString& key_a = classes[a].*field;
+            const CacheString& key_b = classes[b].*field;
+            int result = strings.data.compare(key_a.offset, key_a.size, strings.data, key_b.offset, key_b.size);
+            if(result != 0)
+                return result < 0;
+            const CacheString& name_a = classes[a].full_class_name;
+            const CacheString& name_b = classes[b].full_class_name;
+            return strings.data.compare(name_a.offset, name_a.size, strings.data, name_b.offset, name_b.size) < 0;
+        });
+    };
+    sortIndex(full_class_name_index, &CacheClass::full_class_name);
+    sortIndex(class_name_index, &CacheClass::class_name);
+    sortIndex(base_class_index, &CacheClass::base_class_name);
+
+    auto compareStrings = [&strings](const CacheString& a, const CacheString& b)
+    {
+        return strings.data.compare(a.offset, a.size, strings.data, b.offset, b.size);
+    };
+    std::sort(association_index.begin(), association_index.end(), [&](const CacheAssociation& a, const CacheAssociation& b)
+    {
+        int result = compareStrings(a.associated_class, b.associated_class);
+        if(result == 0)
+            result = compareStrings(classes[a.class_index].base_class_name, classes[b.class_index].base_class_name);
+        if(result == 0)
+            result = compareStrings(classes[a.class_index].full_class_name, classes[b.class_index].full_class_name);
+        return result < 0;
+    });
+    // a class which lists the same type twice is only contained once
+    association_index.erase(std::unique(association_index.begin(), association_index.end(), [&](const CacheAssociation& a, const CacheAssociation& b)
+    {
+        return a.class_index == b.class_index && compareStrings(a.associated_class, b.associated_class) == 0;
+    }), association_index.end());
+
+    std::sort(meta_attribute_index.begin(), meta_attribute_index.end(), [&](const CacheMetaAttribute& a, const CacheMetaAttribute& b)
+    {
+        int result = compareStrings(a.key, b.key);
+        if(result == 0)
+            result = compareStrings(a.value, b.value);
+        if(result == 0)
+            result = compareStrings(classes[a.class_index].full_class_name, classes[b.class_index].full_class_name);
+        return result < 0;
+    });
+    meta_attribute_index.erase(std::unique(meta_attribute_index.begin(), meta_attribute_index.end(), [&](const CacheMetaAttribute& a, const CacheMetaAttribute& b)
+    {
+        return a.class_index == b.class_index && compareStrings(a.key, b.key) == 0 && compareStrings(a.value, b.value) == 0;
+    }), meta_attribute_index.end());
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cache_magic, sizeof(cache_magic));
+    header.version = cache_version;
+    header.byte_order = cache_byte_order;
+    header.file_count = files.size();
+    header.class_count = classes.size();
+    header.association_count = associations.size();
+    header.available_class_count = available_classes.size();
+    header.base_class_count = base_classes.size();
+    header.association_index_count = association_index.size();
+    header.undetailed_class_count = undetailed_class_count;
+    header.meta_attribute_count = meta_attribute_index.size();
+    header.string_data_size = strings.data.size();
+
+    std::string image(reinterpret_cast<const char*>(&header), sizeof(header));
+    appendSection(image, files);
+    appendSection(image, classes);
+    appendSection(image, associations);
+    appendSection(image, base_classes);
+    appendSection(image, full_class_name_index);
+    appendSection(image, class_name_index);
+    appendSection(image, base_class_index);
+    appendSection(image, association_index);
+    appendSection(image, meta_attribute_index);
+    image += strings.data;
+    return image;
+}
+
+bool RegistryCache::write(const std::string& cache_file, const std::vector<const XMLPluginFile*>& plugin_files)
+{
+    std::string image = serialize(plugin_files);
+
+    boost::system::error_code error;
+    boost::filesystem::path cache_path(cache_file);
+    if(cache_path.has_parent_path())
+        boost::filesystem::create_directories(cache_path.parent_path(), error);
+
+    // write to a temporary file and rename it, so readers never see a partial cache
+    std::string tmp_file = cache_file + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream file(tmp_file.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(image.data(), image.size());
+        if(!file)
+        {
+            LOG(WARNING) << "Failed to write registry cache " << cache_file;
+            std::remove(tmp_file.c_str());
+            return false;
+        }
+    }
+    if(std::rename(tmp_file.c_str(), cache_file.c_str()) != 0)
+    {
+        LOG(WARNING) << "Failed to replace registry cache " << cache_file;
+        std::remove(tmp_file.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool RegistryCache::writeSharedMemory(const std::string& segment_name, const std::vector<const XMLPluginFile*>& plugin_files)
+{
+    std::string image = serialize(plugin_files);
+
+    // a new segment is created, processes which still use the old one keep their mapping.
+    // If another process created the segment in the meantime it is used as it is, readers
+    // only accept segments owned by their own user. The segment is only accessible by its owner.
+    shm_unlink(segment_name.c_str());
+    int fd = shm_open(segment_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0)
+    {
+        if(errno != EEXIST)
+            LOG(WARNING) << "Failed to create shared registry " << segment_name << ": " << strerror(errno);
+        return false;
+    }
+    if(ftruncate(fd, image.size()) != 0)
+    {
+        LOG(WARNING) << "Failed to resize shared registry " << segment_name << ": " << strerror(errno);
+        ::close(fd);
+        shm_unlink(segment_name.c_str());
+        return false;
+    }
+    void* mapping = mmap(NULL, image.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        LOG(WARNING) << "Failed to map shared registry " << segment_name << ": " << strerror(errno);
+        shm_unlink(segment_name.c_str());
+        return false;
+    }
+
+    // readers ignore the segment until the magic is set
+    char* segment = static_cast<char*>(mapping);
+    memcpy(segment + sizeof(cache_magic), image.data() + sizeof(cache_magic), image.size() - sizeof(cache_magic));
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(segment, image.data(), sizeof(cache_magic));
+    munmap(mapping, image.size());
+    return true;
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include <boost/noncopyable.hpp>
+#include <boost/utility/string_view.hpp>
+#include "XMLPluginFile.hpp"
+
+namespace plugin_manager
+{
+
+/**
+ * @class RegistryCache
+ * @brief A memory mapped binary image of parsed xml plugin files.
+ * Each cached file is stored together with its fingerprint, a cache entry
+ * is only used if the file on disk still has the same fingerprint.
+ * The layout uses offsets instead of pointers, strings are referenced
+ * by offset and size into a single string section. This makes the image
+ * position independent, so it can be stored in a file or in a shared memory
+ * segment and be queried in place.
+ * Besides the files and classes the image contains sorted indexes of the
+ * available classes, i.e. of the class found in the first file in sorted order
+ * if a class is defined more than once, and indexes of their associated classes and of their
+ * meta attributes.
+ */
+class RegistryCache : public boost::noncopyable
+{
+public:
+    /** Fields of a class record */
+    enum ClassField
+    {
+        CLASS_NAME,
+        FULL_CLASS_NAME,
+        BASE_CLASS_NAME,
+        LIBRARY_PATH,
+        DESCRIPTION,
+        META_ELEMENT,
+        XML_FILE
+    };
+
+    RegistryCache();
+
+    /**
+     * @brief Destructor, unmaps the cache file
+     */
+    ~RegistryCache();
+
+    /**
+     * @brief Maps the given cache file
+     * @param cache_file path to the cache file
+     * @return True if the cache file exists and is valid
+     */
+    bool open(const std::string& cache_file);
+
+    /**
+     * @brief Maps the given shared memory segment read only.
+     * Segments which are not owned by the effective user or are writable by group or others are rejected.
+     * @param segment_name name of the POSIX shared memory segment
+     * @return True if the segment exists, is owned by this user and is valid
+     */
+    bool openSharedMemory(const std::string& segment_name);
+
+    /**
+     * @brief Unmaps the cache file
+     */
+    void close();
+
+    /**
+     * @brief Returns true if a cache file is mapped
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Returns the number of xml files in the cache
+     */
+    size_t getFileCount() const;
+
+    /**
+     * @brief Returns the number of class records, including the classes which are not available
+     */
+    size_t getClassCount() const;
+
+    /**
+     * @brief Looks up the plugin informations of a xml file.
+     * Note: The meta elements of the plugin file are always filled.
+     * @param fingerprint the current fingerprint of the xml file
+     * @param plugin_file the plugin file, its path must be set
+     * @return True if the file is cached with the same fingerprint and could be parsed
+     */
+    bool lookup(const FileFingerprint& fingerprint, XMLPluginFile& plugin_file) const;
+
+    /**
+     * @brief Reads a cached xml file including its path and fingerprint
+     * @param index index of the file, files are sorted by path
+     * @param plugin_file the plugin file
+     * @return True if the entry could be read
+     */
+    bool getFile(size_t index, XMLPluginFile& plugin_file) const;
+
+    /**
+     * @brief Reads only the path, the fingerprint and the parse state of a cached xml file
+     * @param index index of the file, files are sorted by path
+     * @param plugin_file the plugin file, the classes are not touched
+     * @return True if the entry could be read
+     */
+    bool getFileInfo(size_t index, XMLPluginFile& plugin_file) const;
+
+    /**
+     * @brief Returns the index of the class record of an available class
+     * @param full_class_name the class name including namespace
+     * @param class_index the index of the class record
+     * @return True if the class is available
+     */
+    bool findClass(boost::string_view full_class_name, uint32_t& class_index) const;
+
+    /**
+     * @brief Returns the number of available classes with the given name without namespace
+     * @param class_name the class name without namespace
+     * @param class_index the index of the first class record found
+     */
+    size_t findClassesWithoutNamespace(boost::string_view class_name, uint32_t& class_index) const;
+
+    /**
+     * @brief Returns the names of all available classes
+     */
+    void getAvailableClasses(std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns the names of all available classes of a base class
+     */
+    void getAvailableClasses(const std::string& base_class, std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns the names of all available classes whose full name starts with the prefix, sorted by name
+     * @param prefix the prefix of the full class names
+     * @param base_class if not empty only classes of this base class are returned
+     * @param classes the class names are appended
+     */
+    void getClassesWithPrefix(boost::string_view prefix, boost::string_view base_class, std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns true if the details of all available classes are stored.
+     * Only then the association and meta attribute indexes contain all associations and meta attributes.
+     */
+    bool hasAvailableClassDetails() const;
+
+    /**
+     * @brief Returns the names of the available classes of a base class which are associated to the given type
+     * @param embedded_type the canonical name of the associated type
+     * @param base_class the canonical name of the base class
+     * @param classes the class names are appended in sorted order
+     */
+    void getAssociatedClassesOfType(boost::string_view embedded_type, boost::string_view base_class, std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns the names of the available classes which have a meta attribute with the given value.
+     * All meta attributes are indexed, see PluginInfo::meta_attributes.
+     * @param key the key of the meta attribute
+     * @param value the value of the meta attribute
+     * @param base_class if not empty only classes of this base class are returned
+     * @param classes the class names are appended in sorted order
+     */
+    void getClassesWithMeta(boost::string_view key, boost::string_view value, boost::string_view base_class, std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns the index of each available class record, sorted by class name
+     */
+    void getAvailableClassIndexes(std::vector<uint32_t>& class_indexes) const;
+
+    /**
+     * @brief Returns the base class relations declared in all files
+     */
+    void getBaseClasses(std::vector<BaseClassRelation>& base_classes) const;
+
+    /**
+     * @brief Reads a string field of a class record
+     */
+    std::string getClassField(uint32_t class_index, ClassField field) const;
+
+    /**
+     * @brief Returns the singleton flag of a class record
+     */
+    bool isSingleton(uint32_t class_index) const;
+
+    /**
+     * @brief Returns true if the description, the associations and the meta element of the class record are set
+     */
+    bool hasClassDetails(uint32_t class_index) const;
+
+    /**
+     * @brief Reads the associated classes of a class record
+     */
+    void getAssociatedClasses(uint32_t class_index, std::vector<std::string>& associated_classes) const;
+
+    /**
+     * @brief Reads a class record
+     * @param class_index index of the class record
+     * @param plugin_info the plugin info to fill
+     * @return True if the record could be read
+     */
+    bool readClass(uint32_t class_index, PluginInfo& plugin_info) const;
+
+    /**
+     * @brief Writes a new cache file.
+     * The file is replaced atomically, processes which have the old file mapped are not affected.
+     * @param cache_file path to the cache file
+     * @param plugin_files the parsed plugin files, including the meta elements.
+     *                     Files without a valid fingerprint are skipped.
+     * @return True if the cache file could be written
+     */
+    static bool write(const std::string& cache_file, const std::vector<const XMLPluginFile*>& plugin_files);
+
+    /**
+     * @brief Creates a new read only shared memory segment, an existing segment is replaced.
+     * The segment is only accessible by the effective user.
+     * Processes which have the old segment mapped are not affected.
+     * @param segment_name name of the POSIX shared memory segment
+     * @param plugin_files the parsed plugin files, including the meta elements.
+     *                     Files without a valid fingerprint are skipped.
+     * @return True if the segment was created
+     */
+    static bool writeSharedMemory(const std::string& segment_name, const std::vector<const XMLPluginFile*>& plugin_files);
+
+private:
+    /**
+     * @brief Creates the binary image of the plugin files
+     */
+    static std::string serialize(const std::vector<const XMLPluginFile*>& plugin_files);
+
+    /**
+     * @brief Maps the given file descriptor and validates the content
+     * @param check_owner if true the file must be owned by the effective user and not be writable by others
+     */
+    bool map(int fd, const std::string& name, bool check_owner);
+
+    /**
+     * @brief Validates the header and the section sizes of the mapped file
+     */
+    bool validate() const;
+
+    /** Start of the mapped cache file */
+    const char* data;
+
+    /** Size of the mapped cache file */
+    size_t data_size;
+};
+
+}
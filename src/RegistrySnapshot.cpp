@@ -0,0 +1,232 @@
+#include "RegistrySnapshot.hpp"
+#include <algorithm>
+
+using namespace plugin_manager;
+
+RegistrySnapshot::RegistrySnapshot(const std::vector<PluginInfoPtr>& available_classes, const boost::shared_ptr<const ClassHierarchy>& class_hierarchy,
+                                   const std::set<std::string>& meta_index_keys) :
+                                   classes(available_classes), meta_index_keys(meta_index_keys), class_hierarchy(class_hierarchy)
+{
+    buildHashIndex();
+    buildIndex(class_name_index, &PluginInfo::class_name);
+    buildIndex(base_class_index, &PluginInfo::base_class_name);
+    buildIndex(library_index, &PluginInfo::library_path);
+    buildAssociationIndex();
+    buildMetaIndex();
+}
+
+void RegistrySnapshot::buildIndex(std::vector<uint32_t>& index, std::string PluginInfo::*field) const
+{
+    // the classes are sorted by full name, a stable sort keeps that order for equal keys
+    index.resize(classes.size());
+    for(uint32_t i = 0; i < index.size(); i++)
+        index[i] = i;
+    std::stable_sort(index.begin(), index.end(),
+                     [&](uint32_t a, uint32_t b) { return (*classes[a]).*field < (*classes[b]).*field; });
+}
+
+void RegistrySnapshot::buildHashIndex()
+{
+    hash_index.resize(classes.size());
+    for(uint32_t i = 0; i < classes.size(); i++)
+    {
+        hash_index[i].hash = StringPool::hashString(classes[i]->full_class_name.data(), classes[i]->full_class_name.size());
+        hash_index[i].class_index = i;
+    }
+    std::sort(hash_index.begin(), hash_index.end(), [](const HashEntry& a, const HashEntry& b) { return a.hash < b.hash; });
+}
+
+void RegistrySnapshot::buildAssociationIndex()
+{
+    for(uint32_t i = 0; i < classes.size(); i++)
+    {
+        for(const std::string& associated_class : classes[i]->associated_classes)
+        {
+            AssociationEntry entry;
+            entry.associated_class = &associated_class;
+            entry.class_index = i;
+            association_index.push_back(entry);
+        }
+    }
+
+    // the class index gives the order of the full class names
+    std::sort(association_index.begin(), association_index.end(), [this](const AssociationEntry& a, const AssociationEntry& b)
+    {
+        int result = a.associated_class->compare(*b.associated_class);
+        if(result == 0)
+            result = classes[a.class_index]->base_class_name.compare(classes[b.class_index]->base_class_name);
+        return result != 0 ? result < 0 : a.class_index < b.class_index;
+    });
+    // a class which lists the same type twice is only contained once
+    association_index.erase(std::unique(association_index.begin(), association_index.end(), [](const AssociationEntry& a, const AssociationEntry& b)
+    {
+        return a.class_index == b.class_index && *a.associated_class == *b.associated_class;
+    }), association_index.end());
+}
+
+void RegistrySnapshot::buildMetaIndex()
+{
+    if(meta_index_keys.empty())
+        return;
+    for(uint32_t i = 0; i < classes.size(); i++)
+    {
+        for(const MetaAttribute& meta_attribute : classes[i]->meta_attributes)
+        {
+            if(meta_index_keys.count(meta_attribute.first) == 0)
+                continue;
+            MetaEntry entry;
+            entry.meta_attribute = &meta_attribute;
+            entry.class_index = i;
+            meta_index.push_back(entry);
+        }
+    }
+
+    std::sort(meta_index.begin(), meta_index.end(), [](const MetaEntry& a, const MetaEntry& b)
+    {
+        if(*a.meta_attribute != *b.meta_attribute)
+            return *a.meta_attribute < *b.meta_attribute;
+        return a.class_index < b.class_index;
+    });
+    meta_index.erase(std::unique(meta_index.begin(), meta_index.end(), [](const MetaEntry& a, const MetaEntry& b)
+    {
+        return a.class_index == b.class_index && *a.meta_attribute == *b.meta_attribute;
+    }), meta_index.end());
+}
+
+RegistrySnapshot::IndexRange RegistrySnapshot::equalRange(const std::vector<uint32_t>& index, std::string PluginInfo::*field,
+                                                          boost::string_view key) const
+{
+    std::vector<uint32_t>::const_iterator begin = std::lower_bound(index.begin(), index.end(), key,
+        [&](uint32_t i, boost::string_view k) { return boost::string_view((*classes[i]).*field) < k; });
+    std::vector<uint32_t>::const_iterator end = std::upper_bound(begin, index.end(), key,
+        [&](boost::string_view k, uint32_t i) { return k < boost::string_view((*classes[i]).*field); });
+    return std::make_pair(begin, end);
+}
+
+const RegistrySnapshot::PluginInfoPtr* RegistrySnapshot::findClass(boost::string_view full_class_name) const
+{
+    std::vector<PluginInfoPtr>::const_iterator it = std::lower_bound(classes.begin(), classes.end(), full_class_name,
+        [](const PluginInfoPtr& plugin_info, boost::string_view name) { return boost::string_view(plugin_info->full_class_name) < name; });
+    if(it == classes.end() || (*it)->full_class_name != full_class_name)
+        return NULL;
+    return &*it;
+}
+
+const RegistrySnapshot::PluginInfoPtr* RegistrySnapshot::findClass(boost::string_view full_class_name, uint64_t hash) const
+{
+    // only the names of the classes with the same hash are compared
+    std::vector<HashEntry>::const_iterator it = std::lower_bound(hash_index.begin(), hash_index.end(), hash,
+        [](const HashEntry& entry, uint64_t hash) { return entry.hash < hash; });
+    for(; it != hash_index.end() && it->hash == hash; it++)
+    {
+        if(classes[it->class_index]->full_class_name == full_class_name)
+            return &classes[it->class_index];
+    }
+    return NULL;
+}
+
+size_t RegistrySnapshot::findClassesWithoutNamespace(boost::string_view class_name, const PluginInfoPtr*& plugin_info) const
+{
+    IndexRange range = equalRange(class_name_index, &PluginInfo::class_name, class_name);
+    if(range.first != range.second)
+        plugin_info = &classes[*range.first];
+    return range.second - range.first;
+}
+
+void RegistrySnapshot::getAvailableClasses(std::vector<std::string>& classes) const
+{
+    classes.reserve(classes.size() + this->classes.size());
+    for(const PluginInfoPtr& plugin_info : this->classes)
+        classes.push_back(plugin_info->full_class_name);
+}
+
+void RegistrySnapshot::getAvailableClasses(boost::string_view base_class, std::vector<std::string>& classes) const
+{
+    IndexRange range = equalRange(base_class_index, &PluginInfo::base_class_name, base_class);
+    for(std::vector<uint32_t>::const_iterator it = range.first; it != range.second; it++)
+        classes.push_back(this->classes[*it]->full_class_name);
+}
+
+void RegistrySnapshot::getLibraryClasses(boost::string_view library_path, std::vector<std::string>& classes) const
+{
+    IndexRange range = equalRange(library_index, &PluginInfo::library_path, library_path);
+    for(std::vector<uint32_t>::const_iterator it = range.first; it != range.second; it++)
+        classes.push_back(this->classes[*it]->full_class_name);
+}
+
+void RegistrySnapshot::getClassesWithPrefix(boost::string_view prefix, boost::string_view base_class,
+                                            std::vector<std::string>& classes) const
+{
+    std::vector<PluginInfoPtr>::const_iterator it = std::lower_bound(this->classes.begin(), this->classes.end(), prefix,
+        [](const PluginInfoPtr& plugin_info, boost::string_view name) { return boost::string_view(plugin_info->full_class_name) < name; });
+    for(; it != this->classes.end() && boost::string_view((*it)->full_class_name).starts_with(prefix); it++)
+    {
+        if(base_class.empty() || (*it)->base_class_name == base_class)
+            classes.push_back((*it)->full_class_name);
+    }
+}
+
+void RegistrySnapshot::getAssociatedClassesOfType(boost::string_view embedded_type, boost::string_view base_class,
+                                                  std::vector<std::string>& classes) const
+{
+    typedef std::pair<boost::string_view, boost::string_view> AssociationKey;
+    auto compareKey = [this](const AssociationEntry& entry, const AssociationKey& key)
+    {
+        int result = boost::string_view(*entry.associated_class).compare(key.first);
+        if(result != 0)
+            return result;
+        return boost::string_view(this->classes[entry.class_index]->base_class_name).compare(key.second);
+    };
+    const AssociationKey key(embedded_type, base_class);
+    std::vector<AssociationEntry>::const_iterator it = std::lower_bound(association_index.begin(), association_index.end(), key,
+        [&](const AssociationEntry& entry, const AssociationKey& k) { return compareKey(entry, k) < 0; });
+    for(; it != association_index.end() && compareKey(*it, key) == 0; it++)
+        classes.push_back(this->classes[it->class_index]->full_class_name);
+}
+
+bool RegistrySnapshot::hasMetaIndex(boost::string_view key) const
+{
+    return meta_index_keys.find(key.to_string()) != meta_index_keys.end();
+}
+
+void RegistrySnapshot::getClassesWithMeta(boost::string_view key, boost::string_view value, boost::string_view base_class,
+                                          std::vector<std::string>& classes) const
+{
+    typedef std::pair<boost::string_view, boost::string_view> MetaKey;
+    auto compareKey = [](const MetaEntry& entry, const MetaKey& key)
+    {
+        int result = boost::string_view(entry.meta_attribute->first).compare(key.first);
+        if(result != 0)
+            return result;
+        return boost::string_view(entry.meta_attribute->second).compare(key.second);
+    };
+    const MetaKey meta_key(key, value);
+    std::vector<MetaEntry>::const_iterator it = std::lower_bound(meta_index.begin(), meta_index.end(), meta_key,
+        [&](const MetaEntry& entry, const MetaKey& k) { return compareKey(entry, k) < 0; });
+    for(; it != meta_index.end() && compareKey(*it, meta_key) == 0; it++)
+    {
+        const PluginInfoPtr& plugin_info = this->classes[it->class_index];
+        if(base_class.empty() || plugin_info->base_class_name == base_class)
+            classes.push_back(plugin_info->full_class_name);
+    }
+}
+
+void RegistrySnapshot::getRegisteredLibraries(std::set<std::string>& libraries) const
+{
+    for(size_t i = 0; i < library_index.size(); i++)
+    {
+        const std::string& library_path = classes[library_index[i]]->library_path;
+        if(i == 0 || library_path != classes[library_index[i - 1]]->library_path)
+            libraries.insert(libraries.end(), library_path);
+    }
+}
+
+const ClassHierarchy& RegistrySnapshot::getClassHierarchy() const
+{
+    return *class_hierarchy;
+}
+
+size_t RegistrySnapshot::size() const
+{
+    return classes.size();
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/utility/string_view.hpp>
+#include "PluginInfo.hpp"
+#include "ClassHierarchy.hpp"
+#include "StringPool.hpp"
+
+namespace plugin_manager
+{
+
+/**
+ * @class RegistrySnapshot
+ * @brief An immutable copy of the available classes of a PluginManager.
+ * The snapshot shares the plugin infos and the class hierarchy with the registry it was
+ * taken from and keeps sorted indexes of them, so it can be queried by any number of threads
+ * without synchronization. The plugin infos must not be changed after the snapshot was taken.
+ */
+class RegistrySnapshot : public boost::noncopyable
+{
+public:
+    typedef boost::shared_ptr<PluginInfo> PluginInfoPtr;
+
+    /**
+     * @brief Creates the snapshot of the given classes
+     * @param available_classes the available classes sorted by full class name, each name must only be contained once
+     * @param class_hierarchy the class hierarchy of the classes, it must not be changed anymore
+     * @param meta_index_keys the keys of the meta attributes which are indexed
+     */
+    RegistrySnapshot(const std::vector<PluginInfoPtr>& available_classes, const boost::shared_ptr<const ClassHierarchy>& class_hierarchy,
+                     const std::set<std::string>& meta_index_keys);
+
+    /**
+     * @brief Returns the class with the given full class name or NULL if it isn't available
+     */
+    const PluginInfoPtr* findClass(boost::string_view full_class_name) const;
+
+    /**
+     * @brief Returns the class with the given full class name or NULL if it isn't available
+     * @param full_class_name the full class name in canonical form
+     * @param hash the hash of the name, see StringPool::hashString
+     */
+    const PluginInfoPtr* findClass(boost::string_view full_class_name, uint64_t hash) const;
+
+    /**
+     * @brief Returns the number of classes with the given name without namespace
+     * @param class_name the class name without namespace
+     * @param plugin_info the first class found
+     */
+    size_t findClassesWithoutNamespace(boost::string_view class_name, const PluginInfoPtr*& plugin_info) const;
+
+    /**
+     * @brief Returns the names of all classes in sorted order
+     */
+    void getAvailableClasses(std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns the names of the classes of a base class in sorted order
+     */
+    void getAvailableClasses(boost::string_view base_class, std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns the names of the classes of a library in sorted order
+     */
+    void getLibraryClasses(boost::string_view library_path, std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns the names of the classes whose full name starts with the prefix in sorted order
+     * @param prefix the prefix of the full class names
+     * @param base_class if not empty only classes of this base class are returned
+     * @param classes the class names are appended
+     */
+    void getClassesWithPrefix(boost::string_view prefix, boost::string_view base_class, std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns the names of the classes of a base class which are associated to the given type
+     * @param embedded_type the canonical name of the associated type
+     * @param base_class the canonical name of the base class
+     * @param classes the class names are appended in sorted order
+     */
+    void getAssociatedClassesOfType(boost::string_view embedded_type, boost::string_view base_class, std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns true if the meta attributes with the given key are indexed
+     */
+    bool hasMetaIndex(boost::string_view key) const;
+
+    /**
+     * @brief Returns the names of the classes which have a meta attribute with the given value in sorted order
+     * @param key the key of the meta attribute, it must be indexed
+     * @param value the value of the meta attribute
+     * @param base_class if not empty only classes of this base class are returned
+     * @param classes the class names are appended
+     */
+    void getClassesWithMeta(boost::string_view key, boost::string_view value, boost::string_view base_class,
+                            std::vector<std::string>& classes) const;
+
+    /**
+     * @brief Returns the libraries of all classes
+     */
+    void getRegisteredLibraries(std::set<std::string>& libraries) const;
+
+    /**
+     * @brief Returns the class hierarchy of the classes
+     */
+    const ClassHierarchy& getClassHierarchy() const;
+
+    /**
+     * @brief Returns the number of classes
+     */
+    size_t size() const;
+
+private:
+    typedef std::pair<std::vector<uint32_t>::const_iterator, std::vector<uint32_t>::const_iterator> IndexRange;
+
+    /** Entry of the association index, the associated class is owned by the plugin info */
+    struct AssociationEntry
+    {
+        const std::string* associated_class;
+        uint32_t class_index;
+    };
+
+    /** Entry of the meta index, the attribute is owned by the plugin info */
+    struct MetaEntry
+    {
+        const MetaAttribute* meta_attribute;
+        uint32_t class_index;
+    };
+
+    /** Entry of the hash index of the full class names */
+    struct HashEntry
+    {
+        uint64_t hash;
+        uint32_t class_index;
+    };
+
+    /** Creates the hash index sorted by hash */
+    void buildHashIndex();
+
+    /** Creates the association index sorted by associated class, base class and full class name */
+    void buildAssociationIndex();
+
+    /** Creates the meta index sorted by key, value and full class name */
+    void buildMetaIndex();
+
+    /** Returns the entries of an index whose field is equal to the key */
+    IndexRange equalRange(const std::vector<uint32_t>& index, std::string PluginInfo::*field, boost::string_view key) const;
+
+    /** Creates an index sorted by the given field, equal keys are sorted by full class name */
+    void buildIndex(std::vector<uint32_t>& index, std::string PluginInfo::*field) const;
+
+    /** The classes sorted by full class name */
+    std::vector<PluginInfoPtr> classes;
+
+    std::vector<HashEntry> hash_index;
+    std::vector<uint32_t> class_name_index;
+    std::vector<uint32_t> base_class_index;
+    std::vector<uint32_t> library_index;
+    std::vector<AssociationEntry> association_index;
+    std::vector<MetaEntry> meta_index;
+
+    /** The keys of the meta attributes in the meta index */
+    std::set<std::string> meta_index_keys;
+
+    boost::shared_ptr<const ClassHierarchy> class_hierarchy;
+};
+
+}
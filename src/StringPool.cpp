@@ -0,0 +1,63 @@
+#include "StringPool.hpp"
+#include <functional>
+
+using namespace plugin_manager;
+
+size_t StringPool::Hash::operator()(boost::string_view str) const
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for(const char c : str)
+    {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ULL;
+    }
+    return (size_t)hash;
+}
+
+StringId StringPool::intern(boost::string_view str)
+{
+    boost::unordered_map<boost::string_view, StringId, Hash>::const_iterator it = ids.find(str);
+    if(it != ids.end())
+        return it->second;
+
+    StringId id = (StringId)strings.size();
+    strings.push_back(std::string(str.data(), str.size()));
+    ids.insert(std::make_pair(boost::string_view(strings.back()), id));
+    return id;
+}
+
+bool StringPool::find(boost::string_view str, StringId& id) const
+{
+    boost::unordered_map<boost::string_view, StringId, Hash>::const_iterator it = ids.find(str);
+    if(it == ids.end())
+        return false;
+    id = it->second;
+    return true;
+}
+
+bool StringPool::find(boost::string_view str, uint64_t hash, StringId& id) const
+{
+    PrecomputedHash precomputed_hash = {hash};
+    boost::unordered_map<boost::string_view, StringId, Hash>::const_iterator it;
+    it = ids.find(str, precomputed_hash, std::equal_to<boost::string_view>());
+    if(it == ids.end())
+        return false;
+    id = it->second;
+    return true;
+}
+
+const std::string& StringPool::get(StringId id) const
+{
+    return strings[id];
+}
+
+size_t StringPool::size() const
+{
+    return strings.size();
+}
+
+void StringPool::clear()
+{
+    ids.clear();
+    strings.clear();
+}
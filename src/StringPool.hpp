@@ -0,0 +1,99 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+#include <boost/unordered_map.hpp>
+#include <boost/utility/string_view.hpp>
+
+namespace plugin_manager
+{
+
+/** Compact id of an interned string */
+typedef uint32_t StringId;
+
+/** Id which is never assigned to a string */
+static const StringId invalid_string_id = 0xFFFFFFFF;
+
+/**
+ * @class StringPool
+ * @brief Stores each distinct string once and maps it to a compact integer id.
+ * Ids are assigned in ascending order starting at zero and stay valid until the pool is cleared,
+ * so two interned strings are equal if and only if their ids are equal.
+ * Lookups don't allocate, the strings are stored in stable storage and indexed by views on them.
+ */
+class StringPool
+{
+public:
+    /**
+     * @brief Returns the id of the string, the string is added if it isn't known yet
+     */
+    StringId intern(boost::string_view str);
+
+    /**
+     * @brief Looks up the id of a string without adding it
+     * @param str the string
+     * @param id the id of the string
+     * @return True if the string is known
+     */
+    bool find(boost::string_view str, StringId& id) const;
+
+    /**
+     * @brief Looks up the id of a string with a precomputed hash, see hashString
+     * @param str the string
+     * @param hash the hash of the string
+     * @param id the id of the string
+     * @return True if the string is known
+     */
+    bool find(boost::string_view str, uint64_t hash, StringId& id) const;
+
+    /**
+     * @brief Returns the FNV-1a hash of a string which is used by the pool.
+     * The hash can be computed at compile time, see ClassName.
+     * @param str the string
+     * @param length the length of the string
+     * @param hash the hash of the preceding characters
+     */
+    static constexpr uint64_t hashString(const char* str, size_t length, uint64_t hash = 14695981039346656037ULL)
+    {
+        return length == 0 ? hash : hashString(str + 1, length - 1, (hash ^ (unsigned char)str[0]) * 1099511628211ULL);
+    }
+
+    /**
+     * @brief Returns the string of the given id, the id must be valid
+     */
+    const std::string& get(StringId id) const;
+
+    /**
+     * @brief Returns the number of strings in the pool
+     */
+    size_t size() const;
+
+    /**
+     * @brief Removes all strings, previously returned ids become invalid
+     */
+    void clear();
+
+private:
+    /** FNV-1a hash of a string view */
+    struct Hash
+    {
+        size_t operator()(boost::string_view str) const;
+    };
+
+    /** Returns a hash which was computed before */
+    struct PrecomputedHash
+    {
+        uint64_t hash;
+        size_t operator()(boost::string_view) const { return (size_t)hash; }
+    };
+
+    /** Interned strings indexed by id, a deque never moves its elements */
+    std::deque<std::string> strings;
+
+    /** Mapping between the interned strings and their ids */
+    boost::unordered_map<boost::string_view, StringId, Hash> ids;
+};
+
+}
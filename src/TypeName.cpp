@@ -0,0 +1,163 @@
+#include "TypeName.hpp"
+
+using namespace plugin_manager;
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool isWordChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+TypeName::TypeName() : base_begin(0), base_end(0), namespace_end(0), type_begin(0),
+                       arguments_begin(0), arguments_end(0), canonical_name(true)
+{
+}
+
+TypeName::TypeName(boost::string_view name) : TypeName()
+{
+    parse(name);
+}
+
+bool TypeName::parse(boost::string_view name)
+{
+    this->name = name;
+    canonical_name = true;
+    arguments_begin = arguments_end = 0;
+
+    // the parts don't include surrounding whitespace
+    base_begin = 0;
+    while(base_begin < name.size() && isSpace(name[base_begin]))
+        base_begin++;
+    size_t end = name.size();
+    while(end > base_begin && isSpace(name[end - 1]))
+        end--;
+    base_end = end;
+    namespace_end = type_begin = base_begin;
+    if(base_begin != 0 || end != name.size())
+        canonical_name = false;
+
+    int depth = 0;
+    for(size_t i = base_begin; i < end; i++)
+    {
+        const char c = name[i];
+        if(isSpace(c))
+        {
+            // a single space is only needed between two words
+            if(c != ' ' || !isWordChar(name[i - 1]) || !isWordChar(name[i + 1]))
+                canonical_name = false;
+        }
+        else if(c == '<')
+        {
+            if(depth == 0 && arguments_begin == 0)
+            {
+                arguments_begin = i + 1;
+                base_end = i;
+            }
+            depth++;
+        }
+        else if(c == '>')
+        {
+            depth--;
+            if(depth < 0)
+                return false;
+            if(depth == 0 && arguments_end == 0)
+                arguments_end = i;
+        }
+        else if(c == ':' && depth == 0 && arguments_begin == 0 && i + 1 < end && name[i + 1] == ':')
+        {
+            namespace_end = i;
+            type_begin = i + 2;
+            i++;
+        }
+    }
+
+    while(base_end > base_begin && isSpace(name[base_end - 1]))
+        base_end--;
+    if(depth != 0)
+    {
+        if(arguments_end == 0)
+            arguments_end = end;
+        return false;
+    }
+    return true;
+}
+
+boost::string_view TypeName::getNamespace() const
+{
+
+    return name.substr(base_begin, namespace_end - base_begin);
+}
+
+boost::string_view TypeName::getBaseType() const
+{
+    return name.substr(base_begin, base_end - base_begin);
+}
+
+boost::string_view TypeName::getTypeWithoutNamespace() const
+{
+    size_t end = name.size();
+    while(end > type_begin && isSpace(name[end - 1]))
+        end--;
+    return name.substr(type_begin, end - type_begin);
+}
+
+boost::string_view TypeName::getTemplateArguments() const
+{
+    if(!hasTemplateArguments())
+        return boost::string_view();
+    return name.substr(arguments_begin, arguments_end - arguments_begin);
+}
+
+bool TypeName::hasNamespace() const
+{
+    return type_begin != base_begin;
+}
+
+bool TypeName::hasTemplateArguments() const
+{
+    return arguments_begin != 0;
+}
+
+bool TypeName::isCanonical() const
+{
+    return canonical_name;
+}
+
+void TypeName::appendCanonical(std::string& out) const
+{
+    if(canonical_name)
+    {
+        out.append(name.data(), name.size());
+        return;
+    }
+
+    bool space = false;
+    char previous = 0;
+    for(const char c : name)
+    {
+        if(isSpace(c))
+        {
+            space = true;
+            continue;
+        }
+        if(space && isWordChar(previous) && isWordChar(c))
+            out += ' ';
+        out += c;
+        previous = c;
+        space = false;
+    }
+}
+
+boost::string_view TypeName::canonical(boost::string_view name, std::string& buffer)
+{
+    TypeName type_name(name);
+    if(type_name.isCanonical())
+        return name;
+    buffer.clear();
+    type_name.appendCanonical(buffer);
+    return buffer;
+}
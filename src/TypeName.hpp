@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <stddef.h>
+#include <boost/utility/string_view.hpp>
+
+namespace plugin_manager
+{
+
+/**
+ * @class TypeName
+ * @brief Splits a C++ type name like envire::core::Item<std::vector<int> > into its parts.
+ * The parts are views on the parsed name, parsing doesn't allocate. Brackets are matched,
+ * so nested template arguments are handled.
+ * The canonical form of a type name has no whitespace except a single space between two words,
+ * e.g. "unsigned int". Names which only differ in whitespace have the same canonical form.
+ */
+class TypeName
+{
+public:
+    /**
+     * @brief Creates an empty type name
+     */
+    TypeName();
+
+    /**
+     * @brief Parses the given type name, the name must outlive this object
+     */
+    explicit TypeName(boost::string_view name);
+
+    /**
+     * @brief Parses the given type name, the name must outlive this object
+     * @return False if the brackets are not balanced, the parts are set as far as they could be parsed
+     */
+    bool parse(boost::string_view name);
+
+    /**
+     * @brief Returns the namespace of the type. E.g. envire::core from envire::core::Item<int>
+     */
+    boost::string_view getNamespace() const;
+
+    /**
+     * @brief Returns the type without template arguments. E.g. envire::core::Item from envire::core::Item<int>
+     */
+    boost::string_view getBaseType() const;
+
+    /**
+     * @brief Returns the type without namespace. E.g. Item<int> from envire::core::Item<int>
+     */
+    boost::string_view getTypeWithoutNamespace() const;
+
+    /**
+     * @brief Returns the template arguments. E.g. std::vector<int> from envire::core::Item<std::vector<int> >
+     */
+    boost::string_view getTemplateArguments() const;
+
+    /**
+     * @brief Returns true if the type has a namespace
+     */
+    bool hasNamespace() const;
+
+    /**
+     * @brief Returns true if the type has template arguments
+     */
+    bool hasTemplateArguments() const;
+
+    /**
+     * @brief Returns true if the parsed name is in canonical form
+     */
+    bool isCanonical() const;
+
+    /**
+     * @brief Appends the canonical form of the parsed name to the string
+     */
+    void appendCanonical(std::string& out) const;
+
+    /**
+     * @brief Returns the canonical form of a type name
+     * @param name the type name
+     * @param buffer storage for the canonical form, it is only used if the name isn't canonical
+     * @return The name itself if it is canonical, otherwise a view on the buffer
+     */
+    static boost::string_view canonical(boost::string_view name, std::string& buffer);
+
+private:
+    boost::string_view name;
+    size_t base_begin;
+    size_t base_end;
+    size_t namespace_end;
+    size_t type_begin;
+    size_t arguments_begin;
+    size_t arguments_end;
+    bool canonical_name;
+};
+
+}
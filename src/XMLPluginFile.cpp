@@ -0,0 +1,38 @@
+#include "XMLPluginFile.hpp"
+#include <sys/stat.h>
+
+using namespace plugin_manager;
+
+FileFingerprint::FileFingerprint() : size(0), mtime_sec(0), mtime_nsec(0), inode(0), device(0)
+{
+}
+
+bool FileFingerprint::isValid() const
+{
+    return inode != 0;
+}
+
+bool FileFingerprint::operator==(const FileFingerprint& other) const
+{
+    return size == other.size && mtime_sec == other.mtime_sec && mtime_nsec == other.mtime_nsec &&
+           inode == other.inode && device == other.device;
+}
+
+bool FileFingerprint::operator!=(const FileFingerprint& other) const
+{
+    return !(*this == other);
+}
+
+bool FileFingerprint::fromFile(const std::string& path, FileFingerprint& fingerprint)
+{
+    struct stat file_stat;
+    if(stat(path.c_str(), &file_stat) != 0)
+        return false;
+
+    fingerprint.size = file_stat.st_size;
+    fingerprint.mtime_sec = file_stat.st_mtim.tv_sec;
+    fingerprint.mtime_nsec = file_stat.st_mtim.tv_nsec;
+    fingerprint.inode = file_stat.st_ino;
+    fingerprint.device = file_stat.st_dev;
+    return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include "PluginInfo.hpp"
+
+namespace plugin_manager
+{
+
+/**
+ * Identifies the state of a file on disk.
+ * If any of the fields changes the file has to be parsed again.
+ */
+struct FileFingerprint
+{
+    /** Size of the file in bytes */
+    uint64_t size;
+
+    /** Modification time of the file */
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+
+    /** Inode and device of the file */
+    uint64_t inode;
+    uint64_t device;
+
+    FileFingerprint();
+
+    /**
+     * @brief Returns true if the fingerprint was taken from an existing file
+     */
+    bool isValid() const;
+
+    bool operator==(const FileFingerprint& other) const;
+    bool operator!=(const FileFingerprint& other) const;
+
+    /**
+     * @brief Takes the fingerprint of the given file
+     * @param path path to the file
+     * @param fingerprint the fingerprint of the file
+     * @return True if the file could be accessed
+     */
+    static bool fromFile(const std::string& path, FileFingerprint& fingerprint);
+};
+
+/**
+ * A base class relation declared in a xml file, the first type inherits from the second one.
+ */
+typedef std::pair<std::string, std::string> BaseClassRelation;
+
+/**
+ * Stores the plugin informations found in a single xml plugin file.
+ */
+struct XMLPluginFile
+{
+    /** Path to the xml file */
+    std::string path;
+
+    /** State of the file when it was parsed */
+    FileFingerprint fingerprint;
+
+    /** True if the file couldn't be parsed, it is parsed again on the next reload */
+    bool parse_failed;
+
+    /** Plugin informations of all classes in this file */
+    std::vector< boost::shared_ptr<PluginInfo> > classes;
+
+    /** Raw meta element of each class, an empty string if the class has none.
+     *  This is only filled if the file is stored in a registry cache and the
+     *  details of the classes have been parsed, otherwise the vector is empty. */
+    std::vector<std::string> meta_elements;
+
+    /** Base class relations of types which are not plugin classes themselves */
+    std::vector<BaseClassRelation> base_classes;
+
+    XMLPluginFile() : parse_failed(false) {}
+};
+
+}
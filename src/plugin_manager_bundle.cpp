@@ -0,0 +1,29 @@
+#include "PluginManager.hpp"
+#include <iostream>
+
+using namespace plugin_manager;
+
+/**
+ * Compiles the xml plugin files of the given folders into registry bundles.
+ * This is called at install time by the install_plugin_bundle CMake function.
+ */
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <plugin xml folder>..." << std::endl;
+        return 1;
+    }
+
+    PluginManager plugin_manager(std::vector<std::string>(), false, false);
+    int result = 0;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!plugin_manager.writeRegistryBundle(argv[i]))
+        {
+            std::cerr << "Failed to write the registry bundle of " << argv[i] << std::endl;
+            result = 1;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,240 @@
+#include <plugin_manager/PluginXmlParser.hpp>
+#include <boost/filesystem.hpp>
+#include <tinyxml.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace plugin_manager;
+
+namespace
+{
+
+/** Heap usage of the process, counted by the replaced operator new and delete */
+size_t allocation_count = 0;
+size_t live_bytes = 0;
+size_t peak_bytes = 0;
+
+/** Space in front of each block, it stores the size of the block */
+const size_t block_header = sizeof(std::max_align_t);
+
+struct Result
+{
+    double milliseconds;
+    size_t allocation_count;
+    size_t peak_bytes;
+    size_t class_count;
+};
+
+typedef std::vector< boost::shared_ptr<PluginInfo> > PluginInfos;
+
+void writePluginFiles(const boost::filesystem::path& folder, size_t file_count, size_t class_count, std::vector<std::string>& files)
+{
+    for(size_t i = 0; i < file_count; i++)
+    {
+        boost::filesystem::path xml_file = folder / ("plugins_" + std::to_string(i) + ".xml");
+        std::ofstream file(xml_file.string().c_str(), std::ios::trunc);
+        file << "<library path=\"envire_plugins_" << i << "\">\n";
+        for(size_t j = 0; j < class_count; j++)
+        {
+            file << "  <class class_name=\"envire::Item&lt;envire::Type" << i << "_" << j << "&gt;\" base_class_name=\"envire::core::ItemBase\">\n"
+                 << "    <description>Item of the type Type" << i << "_" << j << ", generated for the parser benchmark.</description>\n"
+                 << "    <associations>\n"
+                 << "      <class class_name=\"envire::Type" << i << "_" << j << "\"/>\n"
+                 << "      <class class_name=\"Eigen::Vector3d\"/>\n"
+                 << "    </associations>\n"
+                 << "    <singleton>false</singleton>\n"
+                 << "    <meta><user_tag frame_name=\"frame_" << j << "\">Generated meta information.</user_tag></meta>\n"
+                 << "  </class>\n";
+        }
+        file << "</library>\n";
+        files.push_back(xml_file.string());
+    }
+}
+
+/** Reads the classes of a file with a TinyXML document, the way the plugin manager did before the streaming parser */
+bool parseWithDocument(const std::string& xml_file, PluginInfos& classes, std::vector<std::string>& meta_elements)
+{
+    TiXmlDocument document;
+    document.LoadFile(xml_file);
+    TiXmlElement* library = document.RootElement();
+    if(library == NULL || library->ValueStr() != "library")
+        return false;
+
+    for(; library != NULL; library = library->NextSiblingElement("library"))
+    {
+        const char* library_path = library->Attribute("path");
+        if(library_path == NULL)
+            continue;
+        for(TiXmlElement* class_element = library->FirstChildElement("class"); class_element != NULL;
+            class_element = class_element->NextSiblingElement("class"))
+        {
+            const char* full_class_name = class_element->Attribute("class_name");
+            const char* base_class_name = class_element->Attribute("base_class_name");
+            if(full_class_name == NULL || base_class_name == NULL)
+                continue;
+            boost::shared_ptr<PluginInfo> plugin_info(new PluginInfo);
+            plugin_info->full_class_name = full_class_name;
+            plugin_info->base_class_name = base_class_name;
+            plugin_info->library_path = library_path;
+            plugin_info->xml_file = xml_file;
+
+            TiXmlElement* singleton_element = class_element->FirstChildElement("singleton");
+            if(singleton_element != NULL && singleton_element->GetText() != NULL)
+                plugin_info->singleton = std::string(singleton_element->GetText()) == "true";
+            TiXmlElement* description_element = class_element->FirstChildElement("description");
+            if(description_element != NULL && description_element->GetText() != NULL)
+                plugin_info->description = description_element->GetText();
+            TiXmlElement* association_element = class_element->FirstChildElement("associations");
+            if(association_element != NULL)
+            {
+                for(TiXmlElement* associated_class = association_element->FirstChildElement("class"); associated_class != NULL;
+                    associated_class = associated_class->NextSiblingElement("class"))
+                {
+                    if(associated_class->Attribute("class_name") != NULL)
+                        plugin_info->associated_classes.push_back(associated_class->Attribute("class_name"));
+                }
+            }
+
+            TiXmlPrinter printer;
+            printer.SetStreamPrinting();
+            TiXmlElement* meta_element = class_element->FirstChildElement("meta");
+            if(meta_element != NULL)
+                meta_element->Accept(&printer);
+            meta_elements.push_back(printer.Str());
+            classes.push_back(plugin_info);
+        }
+    }
+    return true;
+}
+
+bool parseStreaming(const std::string& xml_file, PluginInfos& classes, std::vector<std::string>& meta_elements)
+{
+    PluginXmlParser parser;
+    std::vector<BaseClassRelation> base_classes;
+    return parser.load(xml_file) && parser.parse(true, classes, meta_elements, base_classes);
+}
+
+/** Parses all files, the peak is the largest heap growth while a single file is parsed */
+Result measure(const std::vector<std::string>& files, bool (*parse)(const std::string&, PluginInfos&, std::vector<std::string>&))
+{
+    Result result;
+    result.class_count = 0;
+    const size_t start_allocation_count = allocation_count;
+    const size_t start_bytes = live_bytes;
+    peak_bytes = live_bytes;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(const std::string& file : files)
+    {
+        PluginInfos classes;
+        std::vector<std::string> meta_elements;
+        if(!parse(file, classes, meta_elements))
+            std::cerr << "Failed to parse " << file << std::endl;
+        result.class_count += classes.size();
+    }
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.allocation_count = allocation_count - start_allocation_count;
+    result.peak_bytes = peak_bytes - start_bytes;
+    return result;
+}
+
+void report(const std::string& name, const std::vector<std::string>& files, bool (*parse)(const std::string&, PluginInfos&, std::vector<std::string>&))
+{
+    // each parser runs in its own process, so the peak resident set size of the process belongs to it
+    std::cout.flush();
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        std::cerr << "Failed to fork" << std::endl;
+        return;
+    }
+    if(pid == 0)
+    {
+        // the files are read once before, so both parsers find them in the page cache. The fastest run is reported.
+        Result best = measure(files, parse);
+        for(unsigned i = 0; i < 3; i++)
+        {
+            Result result = measure(files, parse);
+            if(result.milliseconds < best.milliseconds)
+                best = result;
+        }
+        std::cout << name << ": " << best.class_count << " classes in " << best.milliseconds << " ms, "
+                  << best.allocation_count << " allocations, peak heap per file " << best.peak_bytes / 1024.0 << " KiB";
+        std::cout.flush();
+        _exit(0);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    if(wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status))
+    {
+        std::cerr << std::endl << "The benchmark of " << name << " failed" << std::endl;
+        return;
+    }
+    std::cout << ", peak RSS " << usage.ru_maxrss << " KiB" << std::endl;
+}
+
+}
+
+void* operator new(size_t size)
+{
+    char* block = static_cast<char*>(std::malloc(size + block_header));
+    if(block == NULL)
+        throw std::bad_alloc();
+    *reinterpret_cast<size_t*>(block) = size;
+    allocation_count++;
+    live_bytes += size;
+    peak_bytes = std::max(peak_bytes, live_bytes);
+    return block + block_header;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if(ptr == NULL)
+        return;
+    char* block = static_cast<char*>(ptr) - block_header;
+    live_bytes -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+/**
+ * Compares the streaming plugin xml parser with a TinyXML document on generated plugin files.
+ * Each parser runs in a forked process whose peak resident set size is reported.
+ * usage: benchmark_plugin_xml_parser [file count] [classes per file]
+ */
+int main(int argc, char** argv)
+{
+    const size_t file_count = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000;
+    const size_t class_count = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 20;
+
+    boost::filesystem::path folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("plugin_manager_%%%%-%%%%");
+    boost::filesystem::create_directories(folder);
+    std::vector<std::string> files;
+    writePluginFiles(folder, file_count, class_count, files);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "Peak RSS before parsing: " << usage.ru_maxrss << " KiB" << std::endl;
+    report("TiXmlDocument", files, &parseWithDocument);
+    report("PluginXmlParser", files, &parseStreaming);
+
+    boost::filesystem::remove_all(folder);
+    return 0;
+}
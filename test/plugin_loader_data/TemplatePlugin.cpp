@@ -0,0 +1,5 @@
+#include "TemplatePlugin.hpp"
+#include <class_loader/class_loader_register_macro.h>
+
+// registered with a spelling that is not canonical, i.e. with a space between the closing brackets
+CLASS_LOADER_REGISTER_CLASS(plugin_manager::TemplatePlugin<std::vector<double> >, plugin_manager::BaseClass);
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+#include "BaseClass.hpp"
+
+namespace plugin_manager
+{
+
+template<class T>
+class TemplatePlugin : public BaseClass
+{
+public:
+    TemplatePlugin() {}
+
+    T data;
+};
+
+}
@@ -0,0 +1,55 @@
+#include <boost/test/unit_test.hpp>
+#include <plugin_manager/CopyOnWriteMap.hpp>
+#include <boost/shared_ptr.hpp>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+using namespace plugin_manager;
+
+BOOST_AUTO_TEST_CASE(copy_on_write_map_test)
+{
+    CopyOnWriteMap<int, boost::shared_ptr<int> > map;
+    boost::shared_ptr<int> value;
+    BOOST_CHECK(map.find(0, value) == false);
+
+    // replaced copies of the map are deleted, only the current one holds the values
+    boost::shared_ptr<int> first(new int(0));
+    map.insert(0, first);
+    for(int i = 1; i < 100; i++)
+        map.insert(i, boost::shared_ptr<int>(new int(i)));
+    BOOST_CHECK_EQUAL(first.use_count(), 2);
+    BOOST_CHECK(map.find(42, value) && *value == 42);
+
+    map.clear();
+    BOOST_CHECK_EQUAL(first.use_count(), 1);
+    BOOST_CHECK(map.find(42, value) == false);
+
+    // readers always find consistent values while the map is replaced
+    std::atomic<bool> done(false);
+    std::atomic<unsigned> failures(0);
+    std::vector<std::thread> readers;
+    for(unsigned i = 0; i < 4; i++)
+    {
+        readers.push_back(std::thread([&]()
+        {
+            while(!done)
+            {
+                for(int key = 0; key < 1000; key += 7)
+                {
+                    boost::shared_ptr<int> found;
+                    if(map.find(key, found) && (!found || *found != key))
+                        failures++;
+                }
+            }
+        }));
+    }
+    for(int i = 0; i < 1000; i++)
+        map.insert(i, boost::shared_ptr<int>(new int(i)));
+    done = true;
+    for(std::thread& reader : readers)
+        reader.join();
+
+    BOOST_CHECK_EQUAL(failures.load(), 0u);
+    BOOST_CHECK(map.find(999, value) && *value == 999);
+}
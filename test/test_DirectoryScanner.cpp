@@ -0,0 +1,56 @@
+#include <boost/test/unit_test.hpp>
+#include <plugin_manager/DirectoryScanner.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+using namespace plugin_manager;
+
+BOOST_AUTO_TEST_CASE(directory_scanner_test)
+{
+    boost::filesystem::path root = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("plugin_manager_%%%%-%%%%");
+    boost::filesystem::path folder = root / "plugin_manager";
+    boost::filesystem::create_directories(folder);
+    std::ofstream((folder / "a.xml").string().c_str()) << "<library/>";
+    std::ofstream((folder / "B.XML").string().c_str()) << "<library/>";
+    std::ofstream((folder / "c.txt").string().c_str()) << "text";
+    boost::filesystem::create_directories(folder / "sub.xml");
+    boost::filesystem::create_symlink(folder, root / "linked");
+    boost::filesystem::create_hard_link(folder / "a.xml", root / "hard_link.xml");
+    boost::filesystem::create_directories(root / "other");
+    boost::filesystem::create_hard_link(folder / "a.xml", root / "other" / "d.xml");
+
+    DirectoryScanner scanner(".xml");
+    scanner.scan(folder.string() + "/");
+    scanner.scan((root / "linked").string());
+    scanner.scan(folder.string());
+    scanner.scan((root / "hard_link.xml").string());
+    scanner.scan((root / "missing").string());
+    scanner.scan((root / "other").string());
+
+    // the folder is only read once and the hard link refers to a known file
+    const std::set<std::string>& files = scanner.getFiles();
+    BOOST_CHECK(files.size() == 2);
+    BOOST_CHECK(files.count((folder / "a.xml").string()) == 1);
+    BOOST_CHECK(files.count((folder / "B.XML").string()) == 1);
+    BOOST_CHECK(scanner.isKnownFile((root / "linked" / "a.xml").string()));
+    BOOST_CHECK(scanner.isKnownFile((root / "other" / "d.xml").string()));
+    BOOST_CHECK(scanner.isKnownFile((folder / "c.txt").string()) == false);
+
+    // without unique files every name of a file is reported, the folders are still read once
+    boost::filesystem::create_symlink(folder / "a.xml", folder / "a_link.xml");
+    DirectoryScanner all_names(".xml", false);
+    all_names.scan(folder.string());
+    all_names.scan((root / "linked").string());
+    all_names.scan((root / "hard_link.xml").string());
+    all_names.scan((root / "hard_link.xml").string());
+    BOOST_CHECK(all_names.getFiles().size() == 4);
+    BOOST_CHECK(all_names.getFiles().count((folder / "a_link.xml").string()) == 1);
+    BOOST_CHECK(all_names.getFiles().count((root / "hard_link.xml").string()) == 1);
+
+    std::vector<std::string> paths = DirectoryScanner::splitPathList(" /usr/lib/ ::/opt/lib//:");
+    BOOST_CHECK(paths.size() == 2);
+    BOOST_CHECK(paths[0] == "/usr/lib");
+    BOOST_CHECK(paths[1] == "/opt/lib");
+
+    boost::filesystem::remove_all(root);
+}
@@ -0,0 +1,34 @@
+#include <boost/test/unit_test.hpp>
+#include <plugin_manager/NodeArena.hpp>
+#include <map>
+
+using namespace plugin_manager;
+
+BOOST_AUTO_TEST_CASE(node_arena_test)
+{
+    NodeArena arena(1024);
+    typedef ArenaAllocator< std::pair<const int, int> > Allocator;
+    {
+        Allocator allocator(&arena);
+        std::multimap<int, int, std::less<int>, Allocator> index(std::less<int>(), allocator);
+        for(int i = 0; i < 100; i++)
+            index.insert(std::make_pair(i % 10, i));
+        BOOST_CHECK(index.count(3) == 10);
+        size_t reserved_bytes = arena.getReservedBytes();
+        BOOST_CHECK(reserved_bytes > 0);
+
+        // erased nodes are reused
+        index.erase(3);
+        for(int i = 0; i < 10; i++)
+            index.insert(std::make_pair(42, i));
+        BOOST_CHECK(arena.getReservedBytes() == reserved_bytes);
+        BOOST_CHECK(index.count(42) == 10);
+        index.clear();
+    }
+
+    arena.release();
+    BOOST_CHECK(arena.getReservedBytes() == 0);
+    void* node = arena.allocate(4096);
+    BOOST_CHECK(node != NULL);
+    BOOST_CHECK(arena.getReservedBytes() >= 4096);
+}
@@ -0,0 +1,65 @@
+#include <boost/test/unit_test.hpp>
+#include <plugin_manager/PluginManager.hpp>
+#include <plugin_manager/PluginDirectoryWatcher.hpp>
+#include <boost/filesystem.hpp>
+#include <condition_variable>
+#include <fstream>
+
+using namespace plugin_manager;
+
+BOOST_AUTO_TEST_CASE(plugin_directory_watcher_test)
+{
+    boost::filesystem::path xml_folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("plugin_manager_%%%%-%%%%");
+    boost::filesystem::create_directories(xml_folder);
+
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(xml_folder.string());
+    PluginManager plugin_manager(xml_paths, false);
+    BOOST_CHECK(plugin_manager.getAvailableClasses().empty());
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::string> added_classes;
+    std::vector<std::string> removed_classes;
+
+    PluginDirectoryWatcher watcher(plugin_manager, 50);
+    watcher.subscribe("envire::core::ItemBase", [&](const std::string& base_class, const std::vector<std::string>& added,
+                                                    const std::vector<std::string>& removed)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        added_classes.insert(added_classes.end(), added.begin(), added.end());
+        removed_classes.insert(removed_classes.end(), removed.begin(), removed.end());
+        changed.notify_all();
+    });
+    BOOST_CHECK(watcher.start());
+    BOOST_CHECK(watcher.isRunning());
+
+    // deploy a new plugin
+    {
+        std::ofstream file((xml_folder / "vector_plugin.xml").string().c_str());
+        file << "<library path=\"envire_vector_plugin\">\n"
+             << "  <class class_name=\"envire::VectorPlugin\" base_class_name=\"envire::core::ItemBase\"/>\n"
+             << "</library>\n";
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        BOOST_CHECK(changed.wait_for(lock, std::chrono::seconds(5), [&]() { return !added_classes.empty(); }));
+    }
+    BOOST_CHECK(added_classes.size() == 1 && added_classes.front() == "envire::VectorPlugin");
+    {
+        std::lock_guard<std::mutex> lock(watcher.getUpdateMutex());
+        BOOST_CHECK(plugin_manager.isClassInfoAvailable("VectorPlugin"));
+    }
+
+    // remove it again
+    boost::filesystem::remove(xml_folder / "vector_plugin.xml");
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        BOOST_CHECK(changed.wait_for(lock, std::chrono::seconds(5), [&]() { return !removed_classes.empty(); }));
+    }
+    BOOST_CHECK(removed_classes.size() == 1 && removed_classes.front() == "envire::VectorPlugin");
+
+    watcher.stop();
+    BOOST_CHECK(!watcher.isRunning());
+    boost::filesystem::remove_all(xml_folder);
+}
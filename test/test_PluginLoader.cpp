@@ -3,7 +3,11 @@
 #include "plugin_loader_data/BaseClass.hpp"
 #include "plugin_loader_data/FloatPlugin.hpp"
 #include "plugin_loader_data/StringPlugin.hpp"
+#include "plugin_loader_data/TemplatePlugin.hpp"
 #include <plugin_manager/Exceptions.hpp>
+#include <boost/filesystem.hpp>
+#include <thread>
+#include <atomic>
 
 using namespace plugin_manager;
 
@@ -60,6 +64,56 @@ BOOST_AUTO_TEST_CASE(plugin_loader_test)
     BOOST_CHECK((PluginLoader::getInstance()->createInstance<FloatPlugin, BaseClass>("FloatPlugin", float_plugin)));
     BOOST_CHECK(float_plugin->data == 42);
 
+    // create instances of a resolved class
+    ClassHandle handle = PluginLoader::getInstance()->resolve("FloatPlugin");
+    BOOST_CHECK(handle.isValid() && handle.isSingleton());
+    BOOST_CHECK(PluginLoader::getInstance()->isClassOfType(handle, "plugin_manager::BaseClass"));
+    boost::shared_ptr<FloatPlugin> float_plugin_handle;
+    BOOST_CHECK((PluginLoader::getInstance()->createInstance<FloatPlugin, BaseClass>(handle, float_plugin_handle)));
+    BOOST_CHECK(float_plugin_handle.get() == float_plugin.get());
+    BOOST_CHECK(PluginLoader::getInstance()->resolve("SomeNotExistingPlugin").isValid() == false);
+
+    // create instances of a class name hashed at compile time
+    boost::shared_ptr<FloatPlugin> float_plugin_hashed;
+    BOOST_CHECK((PluginLoader::getInstance()->createInstance<FloatPlugin, BaseClass>(PLUGIN_CLASS("FloatPlugin"), float_plugin_hashed)));
+    BOOST_CHECK(float_plugin_hashed.get() == float_plugin.get());
+    BOOST_CHECK(PluginLoader::getInstance()->resolve(PLUGIN_CLASS("plugin_manager::StringPlugin")).isValid());
+
+    // create instances with a factory
+    Factory<BaseClass> string_factory = PluginLoader::getInstance()->getFactory<BaseClass>("StringPlugin");
+    BOOST_CHECK(string_factory.isValid());
+    boost::shared_ptr<BaseClass> string_plugin_c = string_factory();
+    boost::shared_ptr<BaseClass> string_plugin_d = string_factory();
+    BOOST_CHECK(boost::dynamic_pointer_cast<StringPlugin>(string_plugin_c) != NULL);
+    BOOST_CHECK(string_plugin_c.get() != string_plugin_d.get());
+
+    Factory<BaseClass> float_factory = PluginLoader::getInstance()->getFactory<BaseClass>(PLUGIN_CLASS("FloatPlugin"));
+    BOOST_CHECK(float_factory.isValid());
+    BOOST_CHECK(float_factory().get() == float_plugin.get());
+    BOOST_CHECK(PluginLoader::getInstance()->getFactory<BaseClass>("SomeNotExistingPlugin").isValid() == false);
+    BOOST_CHECK(Factory<BaseClass>()() == NULL);
+
+    // classes are looked up by their canonical name, but created with the spelling of the xml file
+    typedef TemplatePlugin< std::vector<double> > VectorPlugin;
+    ClassHandle template_handle = PluginLoader::getInstance()->resolve("plugin_manager::TemplatePlugin<std::vector<double> >");
+    BOOST_CHECK(template_handle.isValid());
+    BOOST_CHECK_EQUAL(template_handle.getFullClassName(), "plugin_manager::TemplatePlugin<std::vector<double>>");
+    BOOST_CHECK_EQUAL(template_handle.getRegisteredClassName(), "plugin_manager::TemplatePlugin<std::vector<double> >");
+    boost::shared_ptr<VectorPlugin> vector_plugin;
+    BOOST_CHECK((PluginLoader::getInstance()->createInstance<VectorPlugin, BaseClass>("plugin_manager::TemplatePlugin<std::vector<double>>", vector_plugin)));
+    BOOST_CHECK(vector_plugin != NULL);
+    BOOST_CHECK((PluginLoader::getInstance()->createInstance<VectorPlugin, BaseClass>(template_handle, vector_plugin)));
+    BOOST_CHECK(PluginLoader::getInstance()->getFactory<BaseClass>("TemplatePlugin<std::vector<double> >")() != NULL);
+
+    // the library files are resolved from an index of the library folders
+    std::string library_file = PluginLoader::getInstance()->getLibraryFile(handle.getLibraryPath());
+    BOOST_CHECK(!library_file.empty() && library_file[0] == '/');
+    BOOST_CHECK(PluginLoader::getInstance()->getLibraryFile("some_not_existing_library").empty());
+    PluginLoader::getInstance()->setResolveLibrariesOnReload(true);
+    PluginLoader::getInstance()->reloadXMLPluginFiles();
+    BOOST_CHECK_EQUAL(PluginLoader::getInstance()->getLibraryFile(handle.getLibraryPath()), library_file);
+    PluginLoader::getInstance()->setResolveLibrariesOnReload(false);
+
     // test down case exception
     boost::shared_ptr<FloatPlugin> string_plugin;
     typedef plugin_manager::DownCastException<FloatPlugin, BaseClass> DownCastExceptionType;
@@ -67,3 +121,124 @@ BOOST_AUTO_TEST_CASE(plugin_loader_test)
                       DownCastExceptionType);
 
 }
+
+BOOST_AUTO_TEST_CASE(plugin_loader_thread_test)
+{
+    PluginLoader* loader = PluginLoader::getInstance();
+    std::vector<std::string> xml_paths;
+    const char* root_folder = std::getenv("AUTOPROJ_CURRENT_ROOT");
+    BOOST_CHECK(root_folder != NULL);
+    std::string root_folder_str(root_folder);
+    root_folder_str += "/tools/plugin_manager/test/plugin_loader_data";
+    xml_paths.push_back(root_folder_str);
+    loader->clear();
+    loader->overridePluginXmlPaths(xml_paths);
+    loader->reloadXMLPluginFiles();
+
+    // load the libraries in the background before instances are created
+    std::future<bool> preloaded = loader->preloadLibraries("plugin_manager::BaseClass");
+    BOOST_CHECK(preloaded.get());
+    BOOST_CHECK(loader->preloadLibraries().get());
+    BOOST_CHECK(loader->preloadLibraries(std::vector<std::string>(1, "some_not_existing_library")).get() == false);
+
+    // all threads must get the same singleton instance and a new instance of the other class
+    const unsigned thread_count = 8;
+    std::vector< boost::shared_ptr<FloatPlugin> > float_plugins(thread_count);
+    std::atomic<unsigned> failures(0);
+    std::vector<std::thread> threads;
+    for(unsigned i = 0; i < thread_count; i++)
+    {
+        threads.push_back(std::thread([&, i]()
+        {
+            for(unsigned j = 0; j < 100; j++)
+            {
+                boost::shared_ptr<StringPlugin> string_plugin;
+                boost::shared_ptr<FloatPlugin> float_plugin;
+                if(!PluginLoader::getInstance()->createInstance<StringPlugin, BaseClass>("StringPlugin", string_plugin) ||
+                    !PluginLoader::getInstance()->createInstance<FloatPlugin, BaseClass>("FloatPlugin", float_plugin) ||
+                    string_plugin.use_count() != 1)
+                    failures++;
+                else
+                    float_plugins[i] = float_plugin;
+            }
+        }));
+    }
+    for(std::thread& thread : threads)
+        thread.join();
+
+    BOOST_CHECK_EQUAL(failures.load(), 0u);
+    for(unsigned i = 0; i < thread_count; i++)
+        BOOST_CHECK(float_plugins[i] && float_plugins[i].get() == float_plugins[0].get());
+}
+
+BOOST_AUTO_TEST_CASE(plugin_loader_shared_registry_thread_test)
+{
+    PluginLoader* loader = PluginLoader::getInstance();
+    std::vector<std::string> xml_paths;
+    const char* root_folder = std::getenv("AUTOPROJ_CURRENT_ROOT");
+    BOOST_CHECK(root_folder != NULL);
+    std::string root_folder_str(root_folder);
+    root_folder_str += "/tools/plugin_manager/test/plugin_loader_data";
+    xml_paths.push_back(root_folder_str);
+    const std::string shared_registry = boost::filesystem::unique_path("plugin_loader_%%%%-%%%%").string();
+
+    // another plugin manager creates the shared registry, the loader attaches to it
+    PluginManager creator(xml_paths, false, false);
+    creator.setSharedRegistry(shared_registry);
+    creator.reloadXMLPluginFiles();
+    loader->clear();
+    loader->overridePluginXmlPaths(xml_paths);
+    loader->setSharedRegistry(shared_registry);
+    loader->reloadXMLPluginFiles();
+    BOOST_CHECK(loader->isSharedRegistryAttached());
+
+    // the plugin infos of the shared registry are created by the first thread which needs them
+    const unsigned thread_count = 8;
+    std::atomic<unsigned> failures(0);
+    std::vector<std::thread> threads;
+    for(unsigned i = 0; i < thread_count; i++)
+    {
+        threads.push_back(std::thread([&]()
+        {
+            for(unsigned j = 0; j < 100; j++)
+            {
+                boost::shared_ptr<StringPlugin> string_plugin;
+                boost::shared_ptr<FloatPlugin> float_plugin;
+                std::string description;
+                if(!loader->createInstance<StringPlugin, BaseClass>("StringPlugin", string_plugin) ||
+                   !loader->createInstance<FloatPlugin, BaseClass>(PLUGIN_CLASS("plugin_manager::FloatPlugin"), float_plugin) ||
+                   !loader->getClassDescription("FloatPlugin", description) || description.empty() ||
+                   loader->getPluginInfo("plugin_manager::StringPlugin") == NULL)
+                    failures++;
+            }
+        }));
+    }
+    for(std::thread& thread : threads)
+        thread.join();
+
+    BOOST_CHECK_EQUAL(failures.load(), 0u);
+    BOOST_CHECK(loader->isSharedRegistryAttached());
+
+    loader->removeSharedRegistry();
+    loader->setSharedRegistry(std::string());
+    loader->clear();
+}
+
+BOOST_AUTO_TEST_CASE(plugin_loader_library_alias_test)
+{
+    PluginLoader* loader = PluginLoader::getInstance();
+    const std::string library_file = loader->getLibraryFile("plugin_manager_test_plugins");
+    BOOST_REQUIRE(!library_file.empty());
+
+    // a library which is also reachable under another name keeps both names
+    boost::filesystem::path folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("plugin_loader_%%%%-%%%%");
+    boost::filesystem::create_directories(folder);
+    boost::filesystem::create_symlink(library_file, folder / "libplugin_manager_test_alias.so");
+    loader->addLibraryPath(folder.string());
+    BOOST_CHECK(loader->getLibraryFile("plugin_manager_test_alias") == (folder / "libplugin_manager_test_alias.so").string());
+    BOOST_CHECK(loader->getLibraryFile("plugin_manager_test_plugins") == library_file);
+    BOOST_CHECK(loader->preloadLibraries(std::vector<std::string>(1, "plugin_manager_test_alias")).get());
+
+    boost::filesystem::remove_all(folder);
+    loader->rescanLibraryPaths();
+}
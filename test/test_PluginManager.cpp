@@ -1,17 +1,47 @@
 #include <boost/test/unit_test.hpp>
 #include <plugin_manager/PluginManager.hpp>
+#include <plugin_manager/RegistryCache.hpp>
+#include <boost/filesystem.hpp>
+#include <tinyxml.h>
+#include <fstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
 
 using namespace plugin_manager;
 
-BOOST_AUTO_TEST_CASE(plugin_manager_test)
+/**
+ * Provides the folder of the test data and a temporary folder for generated files,
+ * which is removed after the test even if it failed.
+ */
+struct PluginManagerFixture
+{
+    PluginManagerFixture()
+    {
+        const char* root_folder = std::getenv("AUTOPROJ_CURRENT_ROOT");
+        BOOST_REQUIRE(root_folder != NULL);
+        data_folder = std::string(root_folder) + "/tools/plugin_manager/test/plugin_manager_data";
+        xml_folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("plugin_manager_%%%%-%%%%");
+        boost::filesystem::create_directories(xml_folder);
+    }
+
+    ~PluginManagerFixture()
+    {
+        boost::system::error_code error;
+        boost::filesystem::remove_all(xml_folder, error);
+    }
+
+    std::string data_folder;
+    boost::filesystem::path xml_folder;
+};
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_test, PluginManagerFixture)
 {
     // load xml files
     std::vector<std::string> xml_paths;
-    const char* root_folder = std::getenv("AUTOPROJ_CURRENT_ROOT");
-    BOOST_CHECK(root_folder != NULL);
-    std::string root_folder_str(root_folder);
-    root_folder_str += "/tools/plugin_manager/test/plugin_manager_data";
-    xml_paths.push_back(root_folder_str);
+    xml_paths.push_back(data_folder);
     PluginManager plugin_manager(xml_paths, false);
 
     // check available classes
@@ -52,6 +82,14 @@ BOOST_AUTO_TEST_CASE(plugin_manager_test)
     BOOST_CHECK(associated_classes.front() == "Eigen::Vector3d");
     BOOST_CHECK(plugin_manager.getAssociatedClasses("FakePlugin", associated_classes) == false);
 
+    // get the classes associated to a type
+    std::string associated_class;
+    BOOST_CHECK(plugin_manager.getAssociatedClassOfType("Eigen::Vector3d", "envire::core::ItemBase", associated_class));
+    BOOST_CHECK(associated_class == "envire::VectorPlugin");
+    BOOST_CHECK(plugin_manager.getAssociatedClassOfType("Eigen::Vector3d", "UnknownBase", associated_class) == false);
+    BOOST_CHECK(plugin_manager.getAssociatedClassesOfType("Eigen::Vector3d", "envire::core::ItemBase").size() == 1);
+    BOOST_CHECK(plugin_manager.getAssociatedClassesOfType("UnknownType", "envire::core::ItemBase").empty());
+
     // get library path
     std::string library_path;
     BOOST_CHECK(plugin_manager.getClassLibraryPath("envire::VectorPlugin", library_path));
@@ -70,12 +108,52 @@ BOOST_AUTO_TEST_CASE(plugin_manager_test)
     BOOST_CHECK(std::find(libs.begin(), libs.end(), "envire_vector_plugin") != libs.end());
     BOOST_CHECK(std::find(libs.begin(), libs.end(), "envire_string_plugin") != libs.end());
 
+    // get the classes of a namespace
+    std::vector<std::string> namespace_classes = plugin_manager.getClassesInNamespace("envire");
+    BOOST_CHECK(namespace_classes.size() == 3 && namespace_classes.front() == "envire::FakePlugin");
+    BOOST_CHECK(plugin_manager.getClassesInNamespace("envire::", "envire::core::ItemBase").size() == 3);
+    BOOST_CHECK(plugin_manager.getClassesInNamespace("envire", "UnknownBase").empty());
+    BOOST_CHECK(plugin_manager.getClassesInNamespace("envi").empty());
+    namespace_classes = plugin_manager.getClassesWithPrefix("envire::S");
+    BOOST_CHECK(namespace_classes.size() == 1 && namespace_classes.front() == "envire::StringPlugin");
+
+    // access the plugin info without copies, a substring can be used as class name
+    const std::string names = "envire::VectorPlugin envire::StringPlugin";
+    const PluginInfo* plugin_info = plugin_manager.getPluginInfo(boost::string_view(names).substr(0, 20));
+    BOOST_CHECK(plugin_info != NULL);
+    BOOST_CHECK(plugin_info->full_class_name == "envire::VectorPlugin");
+    BOOST_CHECK(plugin_info->library_path == "envire_vector_plugin");
+    BOOST_CHECK(plugin_info->associated_classes.size() == 1);
+    BOOST_CHECK(plugin_manager.getPluginInfo("UnknownPlugin") == NULL);
+
+    // query the meta attributes with and without index
+    BOOST_CHECK(plugin_info->meta_attributes.size() == 2);
+    BOOST_CHECK(plugin_info->meta_attributes.front() == MetaAttribute("user_tag.frame_name", "laser"));
+    std::vector<std::string> meta_classes = plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser");
+    BOOST_CHECK(meta_classes.size() == 1 && meta_classes.front() == "envire::VectorPlugin");
+    plugin_manager.addMetaIndex("user_tag.frame_name");
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser") == meta_classes);
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser", "envire::core::ItemBase") == meta_classes);
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser", "UnknownBase").empty());
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "camera").empty());
+
     // remove one of the classes
     BOOST_CHECK(plugin_manager.removeClassInfo("envire::FakePlugin"));
 
     available_classes = plugin_manager.getAvailableClasses();
     BOOST_CHECK(available_classes.size() == 2);
 
+    // list and remove the classes of a library
+    BOOST_CHECK(plugin_manager.getLibraryClasses("envire_vector_plugin").size() == 1);
+    BOOST_CHECK(plugin_manager.removeLibrary("envire_string_plugin") == 1);
+    BOOST_CHECK(plugin_manager.getRegisteredLibraries().size() == 1);
+    BOOST_CHECK(plugin_manager.getLibraryClasses("envire_string_plugin").empty());
+
+    // remove the classes of a base class
+    BOOST_CHECK(plugin_manager.removeClassesOfType("envire::core::ItemBase") == 1);
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser").empty());
+    BOOST_CHECK(plugin_manager.getAvailableClasses().empty());
+
     // remove all classes
     plugin_manager.clear();
     available_classes = plugin_manager.getAvailableClasses();
@@ -86,3 +164,530 @@ BOOST_AUTO_TEST_CASE(plugin_manager_test)
     available_classes = plugin_manager.getAvailableClasses();
     BOOST_CHECK(available_classes.size() == 3);
 }
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_parallel_reload_test, PluginManagerFixture)
+{
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(data_folder);
+    PluginManager sequential_manager(xml_paths, false);
+
+    PluginManager plugin_manager(xml_paths, false, false);
+    plugin_manager.setReloadWorkerThreads(0);
+    BOOST_CHECK(plugin_manager.getReloadWorkerThreads() == 0);
+    plugin_manager.reloadXMLPluginFiles();
+
+    // the result has to be the same as for a sequential reload
+    BOOST_CHECK(plugin_manager.getAvailableClasses() == sequential_manager.getAvailableClasses());
+    std::string library_path;
+    BOOST_CHECK(plugin_manager.getClassLibraryPath("envire::FakePlugin", library_path));
+    BOOST_CHECK(library_path == "envire_vector_plugin");
+}
+
+class MetaCountingPluginManager : public PluginManager
+{
+public:
+    MetaCountingPluginManager(const std::vector<std::string>& plugin_xml_paths, const std::string& registry_cache_file,
+                              bool lazy_loading = false) :
+        PluginManager(plugin_xml_paths, false, false, registry_cache_file)
+    {
+        setLazyLoading(lazy_loading);
+        reloadXMLPluginFiles();
+    }
+
+    std::vector<std::string> frame_names;
+
+protected:
+    virtual void parsePluginMetaInformation(const PluginInfoPtr& plugin_info, TiXmlElement* meta_element)
+    {
+        TiXmlElement* user_tag = meta_element->FirstChildElement("user_tag");
+        if(user_tag != NULL && user_tag->Attribute("frame_name") != NULL)
+            frame_names.push_back(user_tag->Attribute("frame_name"));
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_registry_cache_test, PluginManagerFixture)
+{
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(data_folder);
+
+    boost::filesystem::path cache_file = xml_folder / "registry.cache";
+
+    // the first manager parses the xml files and writes the cache
+    MetaCountingPluginManager parsing_manager(xml_paths, cache_file.string());
+    BOOST_CHECK(boost::filesystem::exists(cache_file));
+    BOOST_CHECK(parsing_manager.frame_names.size() == 1);
+
+    RegistryCache cache;
+    BOOST_CHECK(cache.open(cache_file.string()));
+    BOOST_CHECK(cache.getFileCount() == 3);
+    cache.close();
+
+    // the second manager loads all plugin infos from the cache
+    MetaCountingPluginManager cached_manager(xml_paths, cache_file.string());
+    BOOST_CHECK(cached_manager.getAvailableClasses() == parsing_manager.getAvailableClasses());
+    BOOST_CHECK(cached_manager.frame_names.size() == 1);
+    BOOST_CHECK(cached_manager.frame_names.front() == "laser");
+    const PluginInfo* cached_info = cached_manager.getPluginInfo("envire::VectorPlugin");
+    BOOST_CHECK(cached_info != NULL && cached_info->meta_attributes == parsing_manager.getPluginInfo("envire::VectorPlugin")->meta_attributes);
+    BOOST_CHECK(cached_info != NULL && cached_info->meta_attributes.size() == 2);
+
+    std::vector<std::string> associated_classes;
+    BOOST_CHECK(cached_manager.getAssociatedClasses("VectorPlugin", associated_classes));
+    BOOST_CHECK(associated_classes.size() == 1 && associated_classes.front() == "Eigen::Vector3d");
+    std::string description;
+    BOOST_CHECK(cached_manager.getClassDescription("envire::FakePlugin", description));
+    BOOST_CHECK(description == "This plugin does not really exist.");
+    bool is_singleton = false;
+    BOOST_CHECK(cached_manager.getSingletonFlag("envire::StringPlugin", is_singleton) && is_singleton);
+
+}
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_lazy_loading_test, PluginManagerFixture)
+{
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(data_folder);
+
+    MetaCountingPluginManager plugin_manager(xml_paths, std::string(), true);
+    BOOST_CHECK(plugin_manager.getLazyLoading());
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 3);
+    BOOST_CHECK(plugin_manager.frame_names.empty());
+
+    // the singleton flag is available without loading the details
+    bool is_singleton = false;
+    BOOST_CHECK(plugin_manager.getSingletonFlag("envire::StringPlugin", is_singleton) && is_singleton);
+
+    // the details are loaded on the first query
+    std::string description;
+    BOOST_CHECK(plugin_manager.getClassDescription("VectorPlugin", description));
+    BOOST_CHECK(description == "Vector plugin which is used in the unit tests of the plugin manager.");
+    BOOST_CHECK(plugin_manager.frame_names.size() == 1);
+
+    std::vector<std::string> associated_classes;
+    BOOST_CHECK(plugin_manager.getAssociatedClasses("VectorPlugin", associated_classes));
+    BOOST_CHECK(associated_classes.size() == 1 && associated_classes.front() == "Eigen::Vector3d");
+    BOOST_CHECK(plugin_manager.loadClassDetails("VectorPlugin"));
+    BOOST_CHECK(plugin_manager.frame_names.size() == 1);
+
+    // the associations of the classes not loaded yet are checked one by one
+    std::vector<std::string> classes = plugin_manager.getAssociatedClassesOfType("Eigen::Vector3d", "envire::core::ItemBase");
+    BOOST_CHECK(classes.size() == 1 && classes.front() == "envire::VectorPlugin");
+    BOOST_CHECK(plugin_manager.removeClassInfo("VectorPlugin"));
+    BOOST_CHECK(plugin_manager.getAssociatedClassesOfType("Eigen::Vector3d", "envire::core::ItemBase").empty());
+
+    // the meta attributes of the classes not loaded yet are compared one by one until they are indexed
+    plugin_manager.clear();
+    plugin_manager.addMetaIndex("user_tag.frame_name");
+    plugin_manager.reloadXMLPluginFiles();
+    std::vector<std::string> meta_classes = plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser");
+    BOOST_CHECK(meta_classes.size() == 1 && meta_classes.front() == "envire::VectorPlugin");
+    plugin_manager.loadAllClassDetails();
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser") == meta_classes);
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser", "envire::core::ItemBase") == meta_classes);
+    BOOST_CHECK(plugin_manager.getAssociatedClassesOfType("Eigen::Vector3d", "envire::core::ItemBase") == meta_classes);
+}
+
+static void writePluginXmlFile(const boost::filesystem::path& xml_file, const std::string& library, const std::string& class_name)
+{
+    std::ofstream file(xml_file.string().c_str(), std::ios::trunc);
+    file << "<library path=\"" << library << "\">\n"
+         << "  <class class_name=\"" << class_name << "\" base_class_name=\"envire::core::ItemBase\"/>\n"
+         << "</library>\n";
+}
+
+static void writeAssociatedPluginXmlFile(const boost::filesystem::path& xml_file, const std::string& library, const std::string& class_name,
+                                         const std::string& associated_class, const std::string& frame_name)
+{
+    std::ofstream file(xml_file.string().c_str(), std::ios::trunc);
+    file << "<library path=\"" << library << "\">\n"
+         << "  <class class_name=\"" << class_name << "\" base_class_name=\"envire::core::ItemBase\">\n"
+         << "    <associations><class class_name=\"" << associated_class << "\"/></associations>\n"
+         << "    <meta><user_tag frame_name=\"" << frame_name << "\"/></meta>\n"
+         << "  </class>\n"
+         << "</library>\n";
+}
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_incremental_reload_test, PluginManagerFixture)
+{
+    writePluginXmlFile(xml_folder / "a.xml", "lib_a", "envire::APlugin");
+    writePluginXmlFile(xml_folder / "b.xml", "lib_b", "envire::BPlugin");
+
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(xml_folder.string());
+    PluginManager plugin_manager(xml_paths, false);
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 2);
+
+    // a file that comes first in sorted order takes over an already known class
+    writePluginXmlFile(xml_folder / "0.xml", "lib_0", "envire::BPlugin");
+    plugin_manager.reloadXMLPluginFiles();
+    std::string library_path;
+    BOOST_CHECK(plugin_manager.getClassLibraryPath("envire::BPlugin", library_path));
+    BOOST_CHECK(library_path == "lib_0");
+    BOOST_CHECK(plugin_manager.getAvailableClasses("envire::core::ItemBase").size() == 2);
+
+    // removing it restores the definition of the next file
+    boost::filesystem::remove(xml_folder / "0.xml");
+    plugin_manager.reloadXMLPluginFiles();
+    BOOST_CHECK(plugin_manager.getClassLibraryPath("BPlugin", library_path));
+    BOOST_CHECK(library_path == "lib_b");
+
+    // a modified file replaces its classes
+    writePluginXmlFile(xml_folder / "a.xml", "lib_a", "envire::CPlugin");
+    boost::filesystem::last_write_time(xml_folder / "a.xml", boost::filesystem::last_write_time(xml_folder / "a.xml") + 1);
+    plugin_manager.reloadXMLPluginFiles();
+    BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::APlugin") == false);
+    BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::CPlugin"));
+    BOOST_CHECK(plugin_manager.getAvailableClasses("envire::core::ItemBase").size() == 2);
+
+    // removed classes are restored by the next reload
+    BOOST_CHECK(plugin_manager.removeClassInfo("CPlugin"));
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 1);
+    plugin_manager.reloadXMLPluginFiles();
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 2);
+
+    // the names of replaced classes are released, the number of names stays bounded
+    writePluginXmlFile(xml_folder / "z.xml", "lib_z", "envire::BPlugin");
+    const std::time_t modification_time = boost::filesystem::last_write_time(xml_folder / "a.xml");
+    for(int i = 0; i < 100; i++)
+    {
+        writePluginXmlFile(xml_folder / "a.xml", "lib_" + std::to_string(i), "envire::Plugin" + std::to_string(i));
+        boost::filesystem::last_write_time(xml_folder / "a.xml", modification_time + 1 + i);
+        plugin_manager.reloadXMLPluginFiles();
+        BOOST_CHECK(plugin_manager.getInternedNameCount() < 64);
+    }
+    BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::Plugin99"));
+    BOOST_CHECK(plugin_manager.isClassInfoAvailable("Plugin98") == false);
+    BOOST_CHECK(plugin_manager.getAvailableClasses("envire::core::ItemBase").size() == 2);
+
+    // the shadowed definition is still known after the names were rebuilt
+    boost::filesystem::remove(xml_folder / "b.xml");
+    plugin_manager.reloadXMLPluginFiles();
+    BOOST_CHECK(plugin_manager.getClassLibraryPath("BPlugin", library_path));
+    BOOST_CHECK(library_path == "lib_z");
+}
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_xml_parser_test, PluginManagerFixture)
+{
+    {
+        std::ofstream file((xml_folder / "parser.xml").string().c_str());
+        file << "<?xml version=\"1.0\"?>\n<!-- plugins -->\n"
+             << "<library path='lib_a'>\n"
+             << "  <unknown><class class_name=\"ignored\" base_class_name=\"ignored\"/></unknown>\n"
+             << "  <class class_name=\"envire::Item&lt;int&gt;\" base_class_name=\"envire::core::ItemBase\">\n"
+             << "    <description>  A   &quot;test&quot;\n item </description>\n"
+             << "    <singleton><![CDATA[true]]></singleton>\n"
+             << "    <associations><class class_name=\"int\"/><!-- comment --><class class_name=\"double\"/></associations>\n"
+             << "    <meta><frame>world</frame></meta>\n"
+             << "  </class>\n"
+             << "</library>\n"
+             << "<library path=\"lib_b\"><class class_name=\"envire::Other\" base_class_name=\"envire::core::ItemBase\"/>\n"
+             << "  <class class_name=\"envire::Item&lt; std::vector&lt;double&gt; &gt;\" base_class_name=\"envire::core::ItemBase\"/></library>\n";
+    }
+    {
+        std::ofstream file((xml_folder / "broken.xml").string().c_str());
+        file << "<library path=\"lib_c\"><class class_name=\"envire::Broken\" base_class_name=\"envire::core::ItemBase\">\n";
+    }
+
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(xml_folder.string());
+    PluginManager plugin_manager(xml_paths, false);
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 3);
+    BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::Broken") == false);
+
+    std::string description;
+    BOOST_CHECK(plugin_manager.getClassDescription("envire::Item<int>", description));
+    BOOST_CHECK(description == "A \"test\" item");
+    bool singleton = false;
+    BOOST_CHECK(plugin_manager.getSingletonFlag("envire::Item<int>", singleton));
+    BOOST_CHECK(singleton);
+    std::vector<std::string> associated_classes;
+    BOOST_CHECK(plugin_manager.getAssociatedClasses("envire::Item<int>", associated_classes));
+    BOOST_CHECK(associated_classes.size() == 2 && associated_classes[1] == "double");
+    std::string library_path;
+    BOOST_CHECK(plugin_manager.getClassLibraryPath("Other", library_path));
+    BOOST_CHECK(library_path == "lib_b");
+
+    // type names are registered in canonical form, variants in whitespace find the same class
+    std::string full_class_name;
+    BOOST_CHECK(plugin_manager.getFullClassName("Item<std::vector<double> >", full_class_name));
+    BOOST_CHECK(full_class_name == "envire::Item<std::vector<double>>");
+    BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::Item< std::vector<double>>"));
+    BOOST_CHECK(plugin_manager.isClassOfType("envire::Item<int >", "envire::core::ItemBase"));
+}
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_class_hierarchy_test, PluginManagerFixture)
+{
+    {
+        std::ofstream file((xml_folder / "hierarchy.xml").string().c_str());
+        file << "<library path=\"lib_a\">\n"
+             << "  <base_class class_name=\"envire::core::Item\" base_class_name=\"envire::core::ItemBase\"/>\n"
+             << "  <class class_name=\"envire::APlugin\" base_class_name=\"envire::core::Item\"/>\n"
+             << "  <class class_name=\"envire::BPlugin\" base_class_name=\"envire::APlugin\"/>\n"
+             << "  <class class_name=\"envire::CPlugin\" base_class_name=\"envire::core::ItemBase\"/>\n"
+             << "</library>\n";
+    }
+    boost::filesystem::path cache_file = xml_folder / "registry.cache";
+
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(xml_folder.string());
+    PluginManager plugin_manager(xml_paths, false, true, cache_file.string());
+    BOOST_CHECK(plugin_manager.isSubclassOf("BPlugin", "envire::APlugin"));
+    BOOST_CHECK(plugin_manager.isSubclassOf("BPlugin", "envire::core::Item"));
+    BOOST_CHECK(plugin_manager.isSubclassOf("BPlugin", "envire::core::ItemBase"));
+    BOOST_CHECK(plugin_manager.isSubclassOf("APlugin", "envire::BPlugin") == false);
+    BOOST_CHECK(plugin_manager.isSubclassOf("CPlugin", "envire::core::Item") == false);
+    BOOST_CHECK(plugin_manager.getAvailableClasses("envire::core::ItemBase").size() == 1);
+    std::vector<std::string> classes = plugin_manager.getAvailableClasses("envire::core::ItemBase", true);
+    BOOST_CHECK(classes.size() == 3 && classes.front() == "envire::APlugin");
+    BOOST_CHECK(plugin_manager.getAvailableClasses("envire::APlugin", true).size() == 1);
+
+    // the hierarchy follows changes of the registry
+    BOOST_CHECK(plugin_manager.removeClassInfo("APlugin"));
+    BOOST_CHECK(plugin_manager.isSubclassOf("BPlugin", "envire::core::ItemBase") == false);
+    BOOST_CHECK(plugin_manager.getAvailableClasses("envire::core::ItemBase", true).size() == 1);
+
+    // the declared base classes are restored from the registry cache
+    PluginManager cached_manager(xml_paths, false, true, cache_file.string());
+    BOOST_CHECK(cached_manager.isSubclassOf("APlugin", "envire::core::ItemBase"));
+    BOOST_CHECK(cached_manager.getAvailableClasses("envire::core::Item", true).size() == 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_registry_bundle_test, PluginManagerFixture)
+{
+    writePluginXmlFile(xml_folder / "a.xml", "lib_a", "envire::APlugin");
+    writePluginXmlFile(xml_folder / "b.xml", "lib_b", "envire::BPlugin");
+
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(xml_folder.string());
+    PluginManager bundle_writer(xml_paths, false, false);
+    BOOST_CHECK(bundle_writer.writeRegistryBundle(xml_folder.string()));
+    BOOST_CHECK(boost::filesystem::exists(xml_folder / "plugin_registry.bundle"));
+
+    // the bundle is used as long as it covers the xml files of the folder
+    {
+        PluginManager plugin_manager(xml_paths, false);
+        BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 2);
+        BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::BPlugin"));
+        std::string library_path;
+        BOOST_CHECK(plugin_manager.getClassLibraryPath("APlugin", library_path));
+        BOOST_CHECK(library_path == "lib_a");
+    }
+
+    // a file edited in place is parsed instead of taken from the bundle,
+    // the modification time is moved explicitly since it may have a coarse resolution
+    writePluginXmlFile(xml_folder / "b.xml", "lib_b", "envire::CPlugin");
+    boost::filesystem::last_write_time(xml_folder / "b.xml", boost::filesystem::last_write_time(xml_folder / "b.xml") + 1);
+    {
+        PluginManager plugin_manager(xml_paths, false);
+        BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 2);
+        BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::CPlugin"));
+        BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::BPlugin") == false);
+        std::string library_path;
+        BOOST_CHECK(plugin_manager.getClassLibraryPath("APlugin", library_path));
+        BOOST_CHECK(library_path == "lib_a");
+    }
+
+    // an added file invalidates the bundle
+    writePluginXmlFile(xml_folder / "d.xml", "lib_d", "envire::DPlugin");
+    {
+        PluginManager plugin_manager(xml_paths, false);
+        BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 3);
+        BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::CPlugin"));
+        BOOST_CHECK(plugin_manager.isClassInfoAvailable("envire::BPlugin") == false);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_shared_registry_test, PluginManagerFixture)
+{
+    writePluginXmlFile(xml_folder / "a.xml", "lib_a", "envire::APlugin");
+    writeAssociatedPluginXmlFile(xml_folder / "b.xml", "lib_b", "envire::BPlugin", "Eigen::Vector3d", "laser");
+    writePluginXmlFile(xml_folder / "c.xml", "lib_c", "envire::APlugin");
+
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(xml_folder.string());
+    const std::string shared_registry = xml_folder.filename().string();
+
+    // the first plugin manager creates the shared registry
+    PluginManager creator(xml_paths, false, false);
+    creator.setSharedRegistry(shared_registry);
+    creator.removeSharedRegistry();
+    creator.reloadXMLPluginFiles();
+    BOOST_CHECK(creator.isSharedRegistryAttached() == false);
+
+    PluginManager plugin_manager(xml_paths, false, false);
+    plugin_manager.setSharedRegistry(shared_registry);
+    plugin_manager.reloadXMLPluginFiles();
+    BOOST_CHECK(plugin_manager.isSharedRegistryAttached());
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 2);
+    BOOST_CHECK(plugin_manager.getAvailableClasses("envire::core::ItemBase").size() == 2);
+    BOOST_CHECK(plugin_manager.getRegisteredLibraries().size() == 2);
+    BOOST_CHECK(plugin_manager.getClassesInNamespace("envire", "envire::core::ItemBase").size() == 2);
+    BOOST_CHECK(plugin_manager.getClassesWithPrefix("envire::B").size() == 1);
+    std::string library_path;
+    BOOST_CHECK(plugin_manager.getClassLibraryPath("APlugin", library_path));
+    BOOST_CHECK(library_path == "lib_a");
+    std::string base_class;
+    BOOST_CHECK(plugin_manager.getBaseClass("envire::BPlugin", base_class));
+    BOOST_CHECK(base_class == "envire::core::ItemBase");
+    BOOST_CHECK(plugin_manager.isClassInfoAvailable("CPlugin") == false);
+
+    // the associations are looked up in the index of the segment
+    BOOST_CHECK(plugin_manager.getAssociatedClassesOfType("Eigen::Vector3d", "envire::core::ItemBase") == std::vector<std::string>(1, "envire::BPlugin"));
+    BOOST_CHECK(plugin_manager.getAssociatedClassOfType("Eigen::Vector3d", "envire::core::ItemBase", base_class));
+    BOOST_CHECK(base_class == "envire::BPlugin");
+    BOOST_CHECK(plugin_manager.getAssociatedClassesOfType("Eigen::Vector3d", "UnknownBase").empty());
+    BOOST_CHECK(plugin_manager.getAssociatedClassesOfType("UnknownType", "envire::core::ItemBase").empty());
+
+    // the segment indexes all meta attributes, the key doesn't need an index
+    const std::vector<std::string> meta_classes(1, "envire::BPlugin");
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser") == meta_classes);
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser", "envire::core::ItemBase") == meta_classes);
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser", "UnknownBase").empty());
+    plugin_manager.addMetaIndex("user_tag.frame_name");
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser") == meta_classes);
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "camera").empty());
+    BOOST_CHECK(plugin_manager.isSharedRegistryAttached());
+
+    // unchanged files keep the registry attached
+    plugin_manager.reloadXMLPluginFiles();
+    BOOST_CHECK(plugin_manager.isSharedRegistryAttached());
+
+    // removing the class with the first definition makes the shadowed one available
+    boost::filesystem::remove(xml_folder / "a.xml");
+    plugin_manager.reloadXMLPluginFiles();
+    BOOST_CHECK(plugin_manager.isSharedRegistryAttached() == false);
+    BOOST_CHECK(plugin_manager.getClassLibraryPath("APlugin", library_path));
+    BOOST_CHECK(library_path == "lib_c");
+
+    // the segment was replaced, a new process attaches to the updated registry
+    PluginManager attached(xml_paths, false, false);
+    attached.setSharedRegistry(shared_registry);
+    attached.reloadXMLPluginFiles();
+    BOOST_CHECK(attached.isSharedRegistryAttached());
+    BOOST_CHECK(attached.removeClassInfo("BPlugin"));
+    BOOST_CHECK(attached.isSharedRegistryAttached() == false);
+    BOOST_CHECK(attached.getAvailableClasses().size() == 1);
+
+    // a segment written in lazy mode has no details, the classes are checked one by one
+    PluginManager lazy_creator(xml_paths, false, false);
+    lazy_creator.setLazyLoading(true);
+    lazy_creator.setSharedRegistry(shared_registry);
+    lazy_creator.removeSharedRegistry();
+    lazy_creator.reloadXMLPluginFiles();
+    PluginManager lazy_attached(xml_paths, false, false);
+    lazy_attached.setLazyLoading(true);
+    lazy_attached.setSharedRegistry(shared_registry);
+    lazy_attached.reloadXMLPluginFiles();
+    BOOST_CHECK(lazy_attached.isSharedRegistryAttached());
+    BOOST_CHECK(lazy_attached.getClassesWithMeta("user_tag.frame_name", "laser") == meta_classes);
+    BOOST_CHECK(lazy_attached.getAssociatedClassesOfType("Eigen::Vector3d", "envire::core::ItemBase") == meta_classes);
+
+    plugin_manager.removeSharedRegistry();
+
+    // segments are only accessible by their owner, segments writable by others are ignored
+    XMLPluginFile plugin_file;
+    plugin_file.path = (xml_folder / "b.xml").string();
+    BOOST_CHECK(FileFingerprint::fromFile(plugin_file.path, plugin_file.fingerprint));
+    std::vector<const XMLPluginFile*> plugin_files(1, &plugin_file);
+    const std::string segment_name = "/" + shared_registry + "_permissions";
+    BOOST_CHECK(RegistryCache::writeSharedMemory(segment_name, plugin_files));
+    int fd = shm_open(segment_name.c_str(), O_RDONLY, 0);
+    BOOST_CHECK(fd >= 0);
+    struct stat segment_stat;
+    BOOST_CHECK(fstat(fd, &segment_stat) == 0 && (segment_stat.st_mode & 0777) == 0600);
+    RegistryCache segment;
+    BOOST_CHECK(segment.openSharedMemory(segment_name));
+    segment.close();
+    BOOST_CHECK(fchmod(fd, 0666) == 0);
+    close(fd);
+    BOOST_CHECK(segment.openSharedMemory(segment_name) == false);
+    shm_unlink(segment_name.c_str());
+}
+
+BOOST_FIXTURE_TEST_CASE(plugin_manager_concurrent_readers_test, PluginManagerFixture)
+{
+    writePluginXmlFile(xml_folder / "a.xml", "lib_a", "envire::APlugin");
+    writeAssociatedPluginXmlFile(xml_folder / "b.xml", "lib_b", "envire::BPlugin", "Eigen::Vector3d", "laser");
+
+    std::vector<std::string> xml_paths;
+    xml_paths.push_back(xml_folder.string());
+    PluginManager plugin_manager(xml_paths, false, false);
+    plugin_manager.setConcurrentReaders(true);
+    BOOST_CHECK(plugin_manager.getConcurrentReaders());
+    plugin_manager.reloadXMLPluginFiles();
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 2);
+    BOOST_CHECK(plugin_manager.getLibraryClasses("lib_b").size() == 1);
+    BOOST_CHECK(plugin_manager.getClassesInNamespace("envire").size() == 2);
+    BOOST_CHECK(plugin_manager.getClassesWithPrefix("envire::A", "envire::core::ItemBase").size() == 1);
+    ClassHandle handle = plugin_manager.resolve("APlugin");
+    BOOST_CHECK(handle.isValid());
+    BOOST_CHECK(plugin_manager.resolve(PLUGIN_CLASS("envire::APlugin")).getFullClassName() == "envire::APlugin");
+    BOOST_CHECK(plugin_manager.resolve(PLUGIN_CLASS("BPlugin")).getFullClassName() == "envire::BPlugin");
+    BOOST_CHECK(!plugin_manager.resolve(PLUGIN_CLASS("envire::UnknownPlugin")).isValid());
+    BOOST_CHECK(plugin_manager.getAssociatedClassesOfType("Eigen::Vector3d", "envire::core::ItemBase") == std::vector<std::string>(1, "envire::BPlugin"));
+    BOOST_CHECK(plugin_manager.getAssociatedClassesOfType("Eigen::Vector3d", "UnknownBase").empty());
+
+    // once the key is indexed the meta attributes are looked up in the index of the snapshot
+    const std::vector<std::string> meta_classes(1, "envire::BPlugin");
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser") == meta_classes);
+    plugin_manager.addMetaIndex("user_tag.frame_name");
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser") == meta_classes);
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser", "envire::core::ItemBase") == meta_classes);
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser", "UnknownBase").empty());
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "camera").empty());
+
+    // readers always see one of the published states
+    std::atomic<bool> stop(false);
+    std::atomic<unsigned> failures(0);
+    std::vector<std::thread> readers;
+    for(unsigned i = 0; i < 4; i++)
+    {
+        readers.push_back(std::thread([&]()
+        {
+            while(!stop)
+            {
+                std::string library_path;
+                if(!plugin_manager.getClassLibraryPath("APlugin", library_path) || library_path != "lib_a")
+                    failures++;
+                size_t class_count = plugin_manager.getAvailableClasses("envire::core::ItemBase").size();
+                if(class_count < 1 || class_count > 2)
+                    failures++;
+                if(plugin_manager.getAvailableClasses("envire::core::ItemBase", true).size() < 1 ||
+                   plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser").size() > 1)
+                    failures++;
+            }
+        }));
+    }
+    for(unsigned i = 0; i < 20; i++)
+    {
+        plugin_manager.removeLibrary("lib_b");
+        plugin_manager.reloadXMLPluginFiles();
+    }
+    stop = true;
+    for(std::thread& reader : readers)
+        reader.join();
+    BOOST_CHECK(failures == 0);
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 2);
+    std::string associated_class;
+    BOOST_CHECK(plugin_manager.getAssociatedClassOfType("Eigen::Vector3d", "envire::core::ItemBase", associated_class));
+    BOOST_CHECK(associated_class == "envire::BPlugin");
+    BOOST_CHECK(plugin_manager.getClassesWithMeta("user_tag.frame_name", "laser") == meta_classes);
+    BOOST_CHECK(plugin_manager.getAvailableClasses("envire::core::ItemBase", true).size() == 2);
+
+    // the changes of a batch are published at once
+    plugin_manager.beginChanges();
+    BOOST_CHECK(plugin_manager.removeClassInfo("envire::BPlugin"));
+    BOOST_CHECK(plugin_manager.removeLibrary("lib_a") == 1);
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 2);
+    plugin_manager.endChanges();
+    BOOST_CHECK(plugin_manager.getAvailableClasses().empty());
+    plugin_manager.reloadXMLPluginFiles();
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 2);
+
+    // handles stay valid after the class was removed
+    BOOST_CHECK(plugin_manager.removeClassInfo("envire::APlugin"));
+    BOOST_CHECK(plugin_manager.isClassInfoAvailable("APlugin") == false);
+    BOOST_CHECK(handle.getLibraryPath() == "lib_a");
+
+    plugin_manager.setConcurrentReaders(false);
+    BOOST_CHECK(plugin_manager.getAvailableClasses().size() == 1);
+}
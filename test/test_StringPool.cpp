@@ -0,0 +1,55 @@
+#include <boost/test/unit_test.hpp>
+#include <plugin_manager/StringPool.hpp>
+#include <plugin_manager/ClassName.hpp>
+
+using namespace plugin_manager;
+
+BOOST_AUTO_TEST_CASE(string_pool_test)
+{
+    StringPool pool;
+    StringId base = pool.intern("base::Base");
+    StringId plugin = pool.intern(std::string("plugin::Plugin"));
+    BOOST_CHECK(base != plugin);
+    BOOST_CHECK(pool.intern("base::Base") == base);
+    BOOST_CHECK(pool.size() == 2);
+
+    // the stored strings stay valid while the pool grows
+    const std::string& base_name = pool.get(base);
+    for(int i = 0; i < 1000; i++)
+        pool.intern("name_" + std::to_string(i));
+    BOOST_CHECK(base_name == "base::Base");
+    BOOST_CHECK(pool.get(plugin) == "plugin::Plugin");
+
+    StringId id = invalid_string_id;
+    BOOST_CHECK(pool.find("plugin::Plugin", id) && id == plugin);
+    BOOST_CHECK(!pool.find("plugin::Unknown", id));
+    BOOST_CHECK(pool.size() == 1002);
+
+    pool.clear();
+    BOOST_CHECK(pool.size() == 0);
+    BOOST_CHECK(!pool.find("base::Base", id));
+}
+
+BOOST_AUTO_TEST_CASE(string_pool_precomputed_hash_test)
+{
+    using namespace plugin_manager::literals;
+    StringPool pool;
+    StringId plugin = pool.intern("plugin::Plugin");
+
+    // the hash is computed at compile time
+    static_assert(PLUGIN_CLASS("plugin::Plugin").getHash() == StringPool::hashString("plugin::Plugin", 14), "");
+    constexpr ClassName class_name = "plugin::Plugin"_plugin_class;
+    BOOST_CHECK(class_name.getName() == "plugin::Plugin");
+    BOOST_CHECK(class_name.getHash() == PLUGIN_CLASS("plugin::Plugin").getHash());
+
+    StringId id = invalid_string_id;
+    BOOST_CHECK(pool.find(class_name.getName(), class_name.getHash(), id) && id == plugin);
+    ClassName unknown = PLUGIN_CLASS("plugin::Unknown");
+    BOOST_CHECK(!pool.find(unknown.getName(), unknown.getHash(), id));
+
+    // the canonical form is checked at compile time as well
+    static_assert(PLUGIN_CLASS("plugin::Plugin<unsigned int>").isCanonical(), "");
+    static_assert(!PLUGIN_CLASS("plugin::Plugin<std::vector<double> >").isCanonical(), "");
+    static_assert(!ClassName::isCanonical(" plugin::Plugin", 15), "");
+    BOOST_CHECK(!ClassName("unsigned  int", 13).isCanonical());
+}
@@ -0,0 +1,45 @@
+#include <boost/test/unit_test.hpp>
+#include <plugin_manager/TypeName.hpp>
+
+using namespace plugin_manager;
+
+BOOST_AUTO_TEST_CASE(type_name_test)
+{
+    TypeName type_name("envire::core::Item<std::vector<Eigen::Vector3d>>");
+    BOOST_CHECK(type_name.hasNamespace() && type_name.hasTemplateArguments());
+    BOOST_CHECK(type_name.getNamespace() == "envire::core");
+    BOOST_CHECK(type_name.getBaseType() == "envire::core::Item");
+    BOOST_CHECK(type_name.getTypeWithoutNamespace() == "Item<std::vector<Eigen::Vector3d>>");
+    BOOST_CHECK(type_name.getTemplateArguments() == "std::vector<Eigen::Vector3d>");
+    BOOST_CHECK(type_name.isCanonical());
+
+    // namespaces of template arguments don't belong to the type
+    BOOST_CHECK(type_name.parse("Item<base::Pose>"));
+    BOOST_CHECK(!type_name.hasNamespace());
+    BOOST_CHECK(type_name.getTypeWithoutNamespace() == "Item<base::Pose>");
+
+    BOOST_CHECK(type_name.parse("StringPlugin"));
+    BOOST_CHECK(!type_name.hasNamespace() && !type_name.hasTemplateArguments());
+    BOOST_CHECK(type_name.getBaseType() == "StringPlugin");
+    BOOST_CHECK(type_name.getNamespace().empty() && type_name.getTemplateArguments().empty());
+
+    BOOST_CHECK(!type_name.parse("Item<int>>"));
+    BOOST_CHECK(!type_name.parse("Item<std::vector<int>"));
+}
+
+BOOST_AUTO_TEST_CASE(type_name_canonical_test)
+{
+    std::string buffer;
+    BOOST_CHECK(TypeName::canonical("envire::Item<int>", buffer) == "envire::Item<int>");
+    BOOST_CHECK(buffer.empty());
+    BOOST_CHECK(TypeName::canonical("envire::Item<int >", buffer) == "envire::Item<int>");
+    BOOST_CHECK(TypeName::canonical(" Item< std::vector<int> > ", buffer) == "Item<std::vector<int>>");
+    BOOST_CHECK(TypeName::canonical("Item<unsigned   int, const\tchar *>", buffer) == "Item<unsigned int,const char*>");
+    BOOST_CHECK(TypeName::canonical("Item<unsigned int>", buffer) == "Item<unsigned int>");
+    BOOST_CHECK(TypeName("Item<unsigned int>").isCanonical());
+
+    TypeName type_name(" envire::Item < int > ");
+    BOOST_CHECK(!type_name.isCanonical());
+    BOOST_CHECK(type_name.getBaseType() == "envire::Item");
+    BOOST_CHECK(type_name.getTypeWithoutNamespace() == "Item < int >");
+}